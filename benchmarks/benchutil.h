@@ -0,0 +1,16 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include <QStringList>
+
+// splits a comma separated option value, skipping empty entries
+inline QStringList splitList(const QString &s)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+	return s.split(',', Qt::SkipEmptyParts);
+#else
+	return s.split(',', QString::SkipEmptyParts);
+#endif
+}
+
+#endif
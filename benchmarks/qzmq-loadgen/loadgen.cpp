@@ -0,0 +1,468 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QTimer>
+#include "qzmqsocket.h"
+#include "qzmqlatencyhistogram.h"
+#include "benchutil.h"
+
+// drives open-loop traffic from many sockets, optionally against local
+//   stand-in servers. each message is a timestamp frame followed by a
+//   payload frame. in dealer mode the servers echo messages back and round
+//   trip times are measured. in push mode the servers are sinks, and one
+//   way times are measured when they run in the same process
+
+static QElapsedTimer g_clock;
+
+static QByteArray makeTimestamp()
+{
+	qint64 now = g_clock.nsecsElapsed();
+	return QByteArray((const char *)&now, sizeof(now));
+}
+
+static qint64 timestampAge(const QByteArray &buf)
+{
+	if(buf.size() != sizeof(qint64))
+		return -1;
+
+	qint64 then;
+	memcpy(&then, buf.data(), sizeof(then));
+	return g_clock.nsecsElapsed() - then;
+}
+
+// payload sizes: fixed, uniform within a range, or exponential around a
+//   mean
+class SizeDistribution
+{
+public:
+	enum Type
+	{
+		Fixed,
+		Uniform,
+		Exponential
+	};
+
+	Type type;
+	int a;
+	int b;
+
+	SizeDistribution() :
+		type(Fixed),
+		a(64),
+		b(64),
+		state_(0x9e3779b97f4a7c15ULL)
+	{
+	}
+
+	// fixed:N, uniform:MIN:MAX or exp:MEAN
+	bool parse(const QString &s)
+	{
+		QStringList parts = s.split(':');
+		if(parts.count() == 2 && parts[0] == "fixed")
+		{
+			type = Fixed;
+			a = parts[1].toInt();
+		}
+		else if(parts.count() == 3 && parts[0] == "uniform")
+		{
+			type = Uniform;
+			a = parts[1].toInt();
+			b = parts[2].toInt();
+		}
+		else if(parts.count() == 2 && parts[0] == "exp")
+		{
+			type = Exponential;
+			a = parts[1].toInt();
+		}
+		else
+			return false;
+
+		return (a >= 0 && (type != Uniform || b >= a));
+	}
+
+	int next()
+	{
+		switch(type)
+		{
+			case Uniform:
+				return a + (int)(random() % (quint64)(b - a + 1));
+			case Exponential:
+			{
+				double u = (double)(random() >> 11) / (double)(1ULL << 53);
+				return (int)(-log(1.0 - u) * a);
+			}
+			default:
+				return a;
+		}
+	}
+
+private:
+	quint64 state_;
+
+	// xorshift64
+	quint64 random()
+	{
+		state_ ^= state_ << 13;
+		state_ ^= state_ >> 7;
+		state_ ^= state_ << 17;
+		return state_;
+	}
+};
+
+class Server : public QObject
+{
+	Q_OBJECT
+
+public:
+	qint64 received;
+	QZmq::LatencyHistogram oneWay;
+
+	Server(bool echo, const QString &addr, QObject *parent = 0) :
+		QObject(parent),
+		received(0),
+		echo_(echo)
+	{
+		sock_ = new QZmq::Socket(echo ? QZmq::Socket::Router : QZmq::Socket::Pull, this);
+		sock_->setShutdownWaitTime(0);
+		connect(sock_, SIGNAL(readyRead()), SLOT(sock_readyRead()));
+
+		if(!sock_->bind(addr))
+			fprintf(stderr, "error: unable to bind to %s\n", qPrintable(addr));
+	}
+
+private:
+	QZmq::Socket *sock_;
+	bool echo_;
+
+private slots:
+	void sock_readyRead()
+	{
+		while(sock_->canRead())
+		{
+			QList< QList<QByteArray> > messages = sock_->readBatch(1000);
+			received += messages.count();
+
+			foreach(const QList<QByteArray> &msg, messages)
+			{
+				if(echo_)
+				{
+					sock_->write(msg);
+				}
+				else if(!msg.isEmpty())
+				{
+					qint64 age = timestampAge(msg.first());
+					if(age >= 0)
+						oneWay.record(age);
+				}
+			}
+		}
+	}
+};
+
+class Client : public QObject
+{
+	Q_OBJECT
+
+public:
+	qint64 sent;
+	qint64 dropped;
+	qint64 replies;
+	QZmq::LatencyHistogram roundTrip;
+
+	Client(bool dealer, const QStringList &addrs, int queueLimit, QObject *parent = 0) :
+		QObject(parent),
+		sent(0),
+		dropped(0),
+		replies(0)
+	{
+		sock_ = new QZmq::Socket(dealer ? QZmq::Socket::Dealer : QZmq::Socket::Push, this);
+		sock_->setShutdownWaitTime(0);
+		sock_->setWriteQueueLimits(queueLimit);
+		connect(sock_, SIGNAL(readyRead()), SLOT(sock_readyRead()));
+
+		foreach(const QString &addr, addrs)
+			sock_->connectToAddress(addr);
+	}
+
+	void send(int size)
+	{
+		QList<QByteArray> msg;
+		msg += makeTimestamp();
+		msg += QByteArray(size, 'x');
+
+		// open loop: if the queue is full, the message is lost rather than
+		//   held back
+		if(sock_->write(msg))
+			++sent;
+		else
+			++dropped;
+	}
+
+private:
+	QZmq::Socket *sock_;
+
+private slots:
+	void sock_readyRead()
+	{
+		while(sock_->canRead())
+		{
+			QList< QList<QByteArray> > messages = sock_->readBatch(1000);
+			replies += messages.count();
+
+			foreach(const QList<QByteArray> &msg, messages)
+			{
+				if(!msg.isEmpty())
+				{
+					qint64 age = timestampAge(msg.first());
+					if(age >= 0)
+						roundTrip.record(age);
+				}
+			}
+		}
+	}
+};
+
+class LoadGen : public QObject
+{
+	Q_OBJECT
+
+public:
+	double rate;
+	int durationSecs;
+	int reportSecs;
+	SizeDistribution sizes;
+	QList<Client*> clients;
+	QList<Server*> servers;
+
+	LoadGen() :
+		rate(1000),
+		durationSecs(10),
+		reportSecs(1),
+		scheduled_(0),
+		next_(0),
+		lastReportSent_(0),
+		lastReportTime_(0)
+	{
+		tickTimer_ = new QTimer(this);
+		connect(tickTimer_, SIGNAL(timeout()), SLOT(tick()));
+		tickTimer_->setTimerType(Qt::PreciseTimer);
+		tickTimer_->setInterval(1);
+
+		reportTimer_ = new QTimer(this);
+		connect(reportTimer_, SIGNAL(timeout()), SLOT(report()));
+	}
+
+signals:
+	void finished();
+
+public slots:
+	void start()
+	{
+		startTime_ = g_clock.nsecsElapsed();
+		lastReportTime_ = startTime_;
+
+		tickTimer_->start();
+		reportTimer_->start(reportSecs * 1000);
+		QTimer::singleShot(durationSecs * 1000, this, SLOT(stop()));
+	}
+
+private:
+	QTimer *tickTimer_;
+	QTimer *reportTimer_;
+	qint64 startTime_;
+	qint64 scheduled_;
+	int next_;
+	qint64 lastReportSent_;
+	qint64 lastReportTime_;
+
+	void totals(qint64 *sent, qint64 *dropped, qint64 *replies, QZmq::LatencyHistogram *latency) const
+	{
+		*sent = 0;
+		*dropped = 0;
+		*replies = 0;
+
+		foreach(Client *c, clients)
+		{
+			*sent += c->sent;
+			*dropped += c->dropped;
+			*replies += c->replies;
+			*latency += c->roundTrip;
+		}
+
+		foreach(Server *s, servers)
+			*latency += s->oneWay;
+	}
+
+private slots:
+	void tick()
+	{
+		// send whatever is due by now, regardless of how the servers are
+		//   keeping up
+		double secs = (double)(g_clock.nsecsElapsed() - startTime_) / 1000000000.0;
+		qint64 due = (qint64)(secs * rate);
+
+		for(; scheduled_ < due; ++scheduled_)
+		{
+			clients[next_]->send(sizes.next());
+			next_ = (next_ + 1) % clients.count();
+		}
+	}
+
+	void report()
+	{
+		qint64 sent, dropped, replies;
+		QZmq::LatencyHistogram latency;
+		totals(&sent, &dropped, &replies, &latency);
+
+		qint64 now = g_clock.nsecsElapsed();
+		double secs = (double)(now - lastReportTime_) / 1000000000.0;
+		double achieved = (secs > 0 ? (sent - lastReportSent_) / secs : 0);
+		lastReportSent_ = sent;
+		lastReportTime_ = now;
+
+		fprintf(stderr, "sent=%lld (%.0f/s) dropped=%lld replies=%lld p50=%.1fus p99=%.1fus max=%.1fus\n",
+			sent, achieved, dropped, replies,
+			latency.percentile(50) / 1000.0, latency.percentile(99) / 1000.0, latency.max() / 1000.0);
+	}
+
+	void stop()
+	{
+		tickTimer_->stop();
+		reportTimer_->stop();
+
+		qint64 sent, dropped, replies;
+		QZmq::LatencyHistogram latency;
+		totals(&sent, &dropped, &replies, &latency);
+
+		double secs = (double)(g_clock.nsecsElapsed() - startTime_) / 1000000000.0;
+
+		printf("{\"target_rate\":%.1f,\"achieved_rate\":%.1f,\"secs\":%.3f,\"sockets\":%d,\"sent\":%lld,\"dropped\":%lld,\"replies\":%lld,\"latency_samples\":%lld,\"p50_us\":%.3f,\"p90_us\":%.3f,\"p99_us\":%.3f,\"p999_us\":%.3f,\"max_us\":%.3f}\n",
+			rate, (secs > 0 ? sent / secs : 0), secs, clients.count(), sent, dropped, replies, latency.count(),
+			latency.percentile(50) / 1000.0, latency.percentile(90) / 1000.0, latency.percentile(99) / 1000.0,
+			latency.percentile(99.9) / 1000.0, latency.max() / 1000.0);
+		fflush(stdout);
+
+		emit finished();
+	}
+};
+
+static void usage(FILE *out = stderr)
+{
+	fprintf(out,
+		"usage: qzmq-loadgen [options]\n"
+		"  --mode=MODE          client, server or both (default both)\n"
+		"  --pattern=PATTERN    push (to sinks) or dealer (to echo servers) (default dealer)\n"
+		"  --servers=LIST       server addresses (default tcp://127.0.0.1:16555)\n"
+		"  --sockets=N          client sockets to open (default 10)\n"
+		"  --fanout=N           servers each client socket connects to (default 1)\n"
+		"  --rate=N             total messages per second (default 1000)\n"
+		"  --size=DIST          fixed:N, uniform:MIN:MAX or exp:MEAN (default fixed:64)\n"
+		"  --queue-limit=N      messages queued per socket before dropping (default 1000)\n"
+		"  --duration=SECS      how long to run (default 10)\n"
+		"  --report=SECS        progress report interval, to stderr (default 1)\n"
+		"  --help               show this help\n");
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication qapp(argc, argv);
+
+	g_clock.start();
+
+	QString mode = "both";
+	QString pattern = "dealer";
+	QStringList serverAddrs = QStringList() << "tcp://127.0.0.1:16555";
+	int socketCount = 10;
+	int fanout = 1;
+	int queueLimit = 1000;
+
+	LoadGen gen;
+
+	QStringList args = qapp.arguments();
+	for(int n = 1; n < args.count(); ++n)
+	{
+		const QString &arg = args[n];
+		QString name = arg.section('=', 0, 0);
+		QString value = arg.section('=', 1);
+
+		if(name == "--mode")
+			mode = value;
+		else if(name == "--pattern")
+			pattern = value;
+		else if(name == "--servers")
+			serverAddrs = splitList(value);
+		else if(name == "--sockets")
+			socketCount = value.toInt();
+		else if(name == "--fanout")
+			fanout = value.toInt();
+		else if(name == "--rate")
+			gen.rate = value.toDouble();
+		else if(name == "--size")
+		{
+			if(!gen.sizes.parse(value))
+			{
+				usage();
+				return 1;
+			}
+		}
+		else if(name == "--queue-limit")
+			queueLimit = value.toInt();
+		else if(name == "--duration")
+			gen.durationSecs = value.toInt();
+		else if(name == "--report")
+			gen.reportSecs = value.toInt();
+		else if(name == "--help")
+		{
+			usage(stdout);
+			return 0;
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	if((mode != "client" && mode != "server" && mode != "both") || (pattern != "push" && pattern != "dealer") ||
+		serverAddrs.isEmpty() || socketCount < 1 || fanout < 1 || gen.rate <= 0 || gen.reportSecs < 1)
+	{
+		usage();
+		return 1;
+	}
+
+	bool dealer = (pattern == "dealer");
+
+	if(mode != "client")
+	{
+		foreach(const QString &addr, serverAddrs)
+			gen.servers += new Server(dealer, addr, &gen);
+	}
+
+	if(mode == "server")
+	{
+		fprintf(stderr, "serving on %s\n", qPrintable(serverAddrs.join(",")));
+		return qapp.exec();
+	}
+
+	for(int n = 0; n < socketCount; ++n)
+	{
+		// spread the sockets evenly over the servers
+		QStringList addrs;
+		for(int i = 0; i < qMin(fanout, serverAddrs.count()); ++i)
+			addrs += serverAddrs[(n + i) % serverAddrs.count()];
+
+		gen.clients += new Client(dealer, addrs, queueLimit, &gen);
+	}
+
+	QObject::connect(&gen, SIGNAL(finished()), &qapp, SLOT(quit()));
+
+	// let the connections get established
+	QTimer::singleShot(500, &gen, SLOT(start()));
+
+	return qapp.exec();
+}
+
+#include "loadgen.moc"
@@ -0,0 +1,480 @@
+#include <stdio.h>
+#include <QCoreApplication>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include "qzmqsocket.h"
+#include "qzmqvalve.h"
+#include "qzmqreqmessage.h"
+#include "qzmqreprouter.h"
+#include "qzmqreqclient.h"
+#include "qzmqlatencyhistogram.h"
+#include "benchutil.h"
+
+// results are printed one per line, as json objects
+
+static int g_basePort = 15555;
+static int g_addrCounter = 0;
+
+// a run stops early if nothing arrives for this long
+static const int IdleTimeout = 3000;
+
+// time for connections and subscriptions to settle before a run
+static const int SettleTime = 200;
+
+static QString makeAddress(const QString &transport)
+{
+	int n = g_addrCounter++;
+
+	if(transport == "inproc")
+		return QString("inproc://qzmqbench-%1").arg(n);
+	else if(transport == "ipc")
+		return QString("ipc:///tmp/qzmqbench-%1-%2").arg(QCoreApplication::applicationPid()).arg(n);
+	else
+		return QString("tcp://127.0.0.1:%1").arg(g_basePort + n);
+}
+
+static QList<QByteArray> makeMessage(int size, int frames)
+{
+	QList<QByteArray> out;
+	for(int n = 0; n < frames; ++n)
+		out += QByteArray(size, 'x');
+	return out;
+}
+
+class ThroughputTest : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum Pattern
+	{
+		PushPull,
+		PubSub,
+		DealerRouter
+	};
+
+	int received;
+	qint64 elapsed;
+
+	ThroughputTest(Pattern pattern, const QString &addr, bool useValve, int size, int frames, int count) :
+		received(0),
+		elapsed(0),
+		count_(count),
+		sent_(0),
+		written_(0),
+		valve_(0)
+	{
+		QZmq::Socket::Type sendType, recvType;
+		if(pattern == PubSub)
+		{
+			sendType = QZmq::Socket::Pub;
+			recvType = QZmq::Socket::Sub;
+		}
+		else if(pattern == DealerRouter)
+		{
+			sendType = QZmq::Socket::Dealer;
+			recvType = QZmq::Socket::Router;
+		}
+		else
+		{
+			sendType = QZmq::Socket::Push;
+			recvType = QZmq::Socket::Pull;
+		}
+
+		sender_ = new QZmq::Socket(sendType, this);
+		receiver_ = new QZmq::Socket(recvType, this);
+
+		// pub/sub drops messages at the hwm rather than blocking
+		if(pattern == PubSub)
+		{
+			sender_->setSendHwm(0);
+			receiver_->setReceiveHwm(0);
+			receiver_->subscribe(QByteArray());
+		}
+
+		sender_->setShutdownWaitTime(0);
+		receiver_->setShutdownWaitTime(0);
+
+		receiver_->bind(addr);
+		sender_->connectToAddress(addr);
+
+		connect(sender_, SIGNAL(messagesWritten(int)), SLOT(sender_messagesWritten(int)));
+
+		if(useValve)
+		{
+			valve_ = new QZmq::Valve(receiver_, this);
+			connect(valve_, SIGNAL(readyRead(const QList<QByteArray> &)), SLOT(valve_readyRead(const QList<QByteArray> &)));
+		}
+		else
+			connect(receiver_, SIGNAL(readyRead()), SLOT(receiver_readyRead()));
+
+		idleTimer_ = new QTimer(this);
+		connect(idleTimer_, SIGNAL(timeout()), SLOT(idleTimer_timeout()));
+		idleTimer_->setSingleShot(true);
+
+		message_ = makeMessage(size, frames);
+	}
+
+	void run()
+	{
+		QEventLoop loop;
+		connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+		QTimer::singleShot(SettleTime, this, SLOT(start()));
+		loop.exec();
+	}
+
+signals:
+	void finished();
+
+private:
+	int count_;
+	int sent_;
+	int written_;
+	QZmq::Socket *sender_;
+	QZmq::Socket *receiver_;
+	QZmq::Valve *valve_;
+	QTimer *idleTimer_;
+	QList<QByteArray> message_;
+	QElapsedTimer timer_;
+
+	void writeMore()
+	{
+		// keep a bounded number of messages queued in the sender
+		while(sent_ < count_ && sent_ - written_ < 1000)
+		{
+			sender_->write(message_);
+			++sent_;
+		}
+	}
+
+	void messagesReceived(int count)
+	{
+		received += count;
+		elapsed = timer_.nsecsElapsed();
+		idleTimer_->start(IdleTimeout);
+
+		if(received >= count_)
+			done();
+	}
+
+	void done()
+	{
+		idleTimer_->stop();
+
+		if(valve_)
+			valve_->close();
+
+		emit finished();
+	}
+
+private slots:
+	void start()
+	{
+		if(valve_)
+			valve_->open();
+
+		timer_.start();
+		idleTimer_->start(IdleTimeout);
+		writeMore();
+	}
+
+	void sender_messagesWritten(int count)
+	{
+		written_ += count;
+		writeMore();
+	}
+
+	void receiver_readyRead()
+	{
+		while(receiver_->canRead() && received < count_)
+			messagesReceived(receiver_->readBatch(1000).count());
+	}
+
+	void valve_readyRead(const QList<QByteArray> &message)
+	{
+		Q_UNUSED(message);
+
+		if(received < count_)
+			messagesReceived(1);
+	}
+
+	void idleTimer_timeout()
+	{
+		// report what made it, measured up to the last arrival
+		done();
+	}
+};
+
+class LatencyTest : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum Pattern
+	{
+		DealerRouter,
+		ReqRep
+	};
+
+	// round trip times, in nanoseconds
+	QZmq::LatencyHistogram histogram;
+
+	LatencyTest(Pattern pattern, const QString &addr, int size, int frames, int count) :
+		count_(count),
+		warmup_(qMin(100, count / 10)),
+		done_(0),
+		client_(0),
+		server_(0),
+		reqClient_(0),
+		repRouter_(0)
+	{
+		if(pattern == ReqRep)
+		{
+			repRouter_ = new QZmq::RepRouter(this);
+			repRouter_->setShutdownWaitTime(0);
+			connect(repRouter_, SIGNAL(readyRead()), SLOT(repRouter_readyRead()));
+			repRouter_->bind(addr);
+
+			reqClient_ = new QZmq::ReqClient(this);
+			reqClient_->setShutdownWaitTime(0);
+			connect(reqClient_, SIGNAL(replyReady(const QByteArray &, const QList<QByteArray> &)), SLOT(reqClient_replyReady(const QByteArray &, const QList<QByteArray> &)));
+			reqClient_->connectToAddress(addr);
+		}
+		else
+		{
+			server_ = new QZmq::Socket(QZmq::Socket::Router, this);
+			server_->setShutdownWaitTime(0);
+			connect(server_, SIGNAL(readyRead()), SLOT(server_readyRead()));
+			server_->bind(addr);
+
+			client_ = new QZmq::Socket(QZmq::Socket::Dealer, this);
+			client_->setShutdownWaitTime(0);
+			connect(client_, SIGNAL(readyRead()), SLOT(client_readyRead()));
+			client_->connectToAddress(addr);
+		}
+
+		message_ = makeMessage(size, frames);
+	}
+
+	void run()
+	{
+		QEventLoop loop;
+		connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+		QTimer::singleShot(SettleTime, this, SLOT(start()));
+
+		// give up if a round trip goes missing, allowing 1ms per round trip
+		QTimer::singleShot(SettleTime + IdleTimeout + count_, &loop, SLOT(quit()));
+		loop.exec();
+	}
+
+signals:
+	void finished();
+
+private:
+	int count_;
+	int warmup_;
+	int done_;
+	QZmq::Socket *client_;
+	QZmq::Socket *server_;
+	QZmq::ReqClient *reqClient_;
+	QZmq::RepRouter *repRouter_;
+	QList<QByteArray> message_;
+	QElapsedTimer timer_;
+
+	void sendNext()
+	{
+		timer_.start();
+
+		if(reqClient_)
+			reqClient_->request(message_);
+		else
+			client_->write(message_);
+	}
+
+	void replyReceived()
+	{
+		qint64 rtt = timer_.nsecsElapsed();
+
+		if(done_ >= warmup_)
+			histogram.record(rtt);
+
+		++done_;
+		if(done_ >= count_ + warmup_)
+		{
+			emit finished();
+			return;
+		}
+
+		sendNext();
+	}
+
+private slots:
+	void start()
+	{
+		sendNext();
+	}
+
+	void server_readyRead()
+	{
+		// echo back. the first part is the peer id
+		while(server_->canRead())
+			server_->write(server_->read());
+	}
+
+	void client_readyRead()
+	{
+		while(client_->canRead())
+		{
+			client_->read();
+			replyReceived();
+		}
+	}
+
+	void repRouter_readyRead()
+	{
+		while(repRouter_->canRead())
+		{
+			QZmq::ReqMessage msg = repRouter_->read();
+			repRouter_->write(msg.takeReply(msg.content()));
+		}
+	}
+
+	void reqClient_replyReady(const QByteArray &id, const QList<QByteArray> &content)
+	{
+		Q_UNUSED(id);
+		Q_UNUSED(content);
+
+		replyReceived();
+	}
+};
+
+static QList<int> parseIntList(const QString &s)
+{
+	QList<int> out;
+	foreach(const QString &part, splitList(s))
+		out += part.toInt();
+	return out;
+}
+
+static void usage(FILE *out = stderr)
+{
+	fprintf(out,
+		"usage: qzmqbench [options]\n"
+		"  --transports=LIST    inproc,ipc,tcp (default all)\n"
+		"  --sizes=LIST         frame sizes in bytes (default 16,256,4096)\n"
+		"  --frames=LIST        frames per message (default 1,4)\n"
+		"  --count=N            messages per throughput run (default 100000)\n"
+		"  --max-bytes=N        cap on payload bytes per throughput run (default 268435456)\n"
+		"  --latency-count=N    round trips per latency run (default 10000)\n"
+		"  --port=N             first tcp port to use (default 15555)\n"
+		"  --no-throughput      skip throughput runs\n"
+		"  --no-latency         skip latency runs\n"
+		"  --help               show this help\n");
+}
+
+int main(int argc, char **argv)
+{
+	QCoreApplication qapp(argc, argv);
+
+	QStringList transports = QStringList() << "inproc" << "ipc" << "tcp";
+	QList<int> sizes = QList<int>() << 16 << 256 << 4096;
+	QList<int> frameCounts = QList<int>() << 1 << 4;
+	int count = 100000;
+	qint64 maxBytes = 256 * 1024 * 1024;
+	int latencyCount = 10000;
+	bool doThroughput = true;
+	bool doLatency = true;
+
+	QStringList args = qapp.arguments();
+	for(int n = 1; n < args.count(); ++n)
+	{
+		const QString &arg = args[n];
+		QString name = arg.section('=', 0, 0);
+		QString value = arg.section('=', 1);
+
+		if(name == "--transports")
+			transports = splitList(value);
+		else if(name == "--sizes")
+			sizes = parseIntList(value);
+		else if(name == "--frames")
+			frameCounts = parseIntList(value);
+		else if(name == "--count")
+			count = value.toInt();
+		else if(name == "--max-bytes")
+			maxBytes = value.toLongLong();
+		else if(name == "--latency-count")
+			latencyCount = value.toInt();
+		else if(name == "--port")
+			g_basePort = value.toInt();
+		else if(name == "--no-throughput")
+			doThroughput = false;
+		else if(name == "--no-latency")
+			doLatency = false;
+		else if(name == "--help")
+		{
+			usage(stdout);
+			return 0;
+		}
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	foreach(const QString &transport, transports)
+	{
+		foreach(int size, sizes)
+		{
+			foreach(int frames, frameCounts)
+			{
+				QByteArray t = transport.toLatin1();
+
+				if(doThroughput)
+				{
+					qint64 messageBytes = qMax((qint64)size * frames, (qint64)1);
+					int messages = (int)qMax((qint64)1000, qMin((qint64)count, maxBytes / messageBytes));
+
+					const char *names[] = { "pushpull", "pubsub", "dealerrouter", "valve" };
+					for(int p = 0; p < 4; ++p)
+					{
+						ThroughputTest::Pattern pattern = (p == 3 ? ThroughputTest::PushPull : (ThroughputTest::Pattern)p);
+
+						ThroughputTest test(pattern, makeAddress(transport), p == 3, size, frames, messages);
+						test.run();
+
+						double secs = (double)test.elapsed / 1000000000.0;
+						double rate = (secs > 0 ? test.received / secs : 0);
+
+						printf("{\"bench\":\"throughput\",\"pattern\":\"%s\",\"transport\":\"%s\",\"size\":%d,\"frames\":%d,\"messages\":%d,\"received\":%d,\"secs\":%.6f,\"msgs_per_sec\":%.1f,\"mbytes_per_sec\":%.3f}\n",
+							names[p], t.data(), size, frames, messages, test.received, secs, rate, rate * messageBytes / 1000000.0);
+						fflush(stdout);
+					}
+				}
+
+				if(doLatency)
+				{
+					const char *names[] = { "dealerrouter", "reprouter" };
+					for(int p = 0; p < 2; ++p)
+					{
+						LatencyTest test((LatencyTest::Pattern)p, makeAddress(transport), size, frames, latencyCount);
+						test.run();
+
+						const QZmq::LatencyHistogram &h = test.histogram;
+						printf("{\"bench\":\"latency\",\"pattern\":\"%s\",\"transport\":\"%s\",\"size\":%d,\"frames\":%d,\"round_trips\":%lld,\"mean_us\":%.3f,\"p50_us\":%.3f,\"p90_us\":%.3f,\"p99_us\":%.3f,\"p999_us\":%.3f,\"max_us\":%.3f}\n",
+							names[p], t.data(), size, frames, h.count(), h.mean() / 1000.0,
+							h.percentile(50) / 1000.0, h.percentile(90) / 1000.0, h.percentile(99) / 1000.0,
+							h.percentile(99.9) / 1000.0, h.max() / 1000.0);
+						fflush(stdout);
+					}
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+#include "qzmqbench.moc"
@@ -0,0 +1,3 @@
+include(../benchmarks.pri)
+
+SOURCES += qzmqbench.cpp
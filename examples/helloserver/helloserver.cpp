@@ -26,16 +26,16 @@ private slots:
 	void sock_readyRead()
 	{
 		QZmq::ReqMessage msg = sock.read();
-		if(msg.content().isEmpty())
+		if(msg.contentCount() == 0)
 		{
 			printf("error: received empty message\n");
 			return;
 		}
 
-		printf("read: %s\n", msg.content()[0].data());
+		printf("read: %s\n", msg.contentAt(0).data());
 		QByteArray out = "world";
 		printf("writing: %s\n", out.data());
-		sock.write(msg.createReply(QList<QByteArray>() << out));
+		sock.write(msg.takeReply(QList<QByteArray>() << out));
 	}
 
 	void sock_messagesWritten(int count)
@@ -1,3 +1,3 @@
 TEMPLATE = subdirs
 
-SUBDIRS += examples
+SUBDIRS += examples benchmarks
@@ -0,0 +1,359 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqcapture.h"
+
+#include <string.h>
+#include <QFile>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+namespace QZmq {
+
+static const char *Magic = "QZMQCAP";
+static const int FileHeaderSize = 16;
+static const int RecordHeaderSize = 24;
+
+static int padding(qint64 size)
+{
+	return (8 - (size & 7)) & 7;
+}
+
+static void put32(char *p, quint32 value)
+{
+	qToLittleEndian<quint32>(value, p);
+}
+
+static void put64(char *p, qint64 value)
+{
+	qToLittleEndian<qint64>(value, p);
+}
+
+static quint32 get32(const uchar *p)
+{
+	return qFromLittleEndian<quint32>(p);
+}
+
+static qint64 get64(const uchar *p)
+{
+	return qFromLittleEndian<qint64>(p);
+}
+
+class Capture::Private
+{
+public:
+	QFile file;
+	int directions;
+
+	// record times are the monotonic clock plus an offset, so that
+	//   appending to an existing file continues its timeline
+	QElapsedTimer clock;
+	qint64 timeOffset;
+
+	QByteArray buf;
+
+	Private() :
+		directions(Capture::Read | Capture::Written),
+		timeOffset(0)
+	{
+	}
+
+	template <typename T>
+	void record(Capture::Direction direction, const QList<T> &message)
+	{
+		if(!file.isOpen() || !(directions & direction))
+			return;
+
+		qint64 dataSize = 0;
+		foreach(const T &part, message)
+			dataSize += part.size();
+
+		qint64 size = RecordHeaderSize + (qint64)message.count() * 4 + dataSize;
+		size += padding(size);
+
+		// the record must fit the 32-bit size field, and the buffer.
+		//   anything bigger is left out
+		if(size > 0x7fffffff)
+			return;
+
+		// one write per record, through a reused buffer
+		buf.resize((int)size);
+		char *p = buf.data();
+
+		put64(p, timeOffset + clock.nsecsElapsed());
+		put32(p + 8, (quint32)size);
+		put32(p + 12, direction);
+		put32(p + 16, message.count());
+		put32(p + 20, 0);
+		p += RecordHeaderSize;
+
+		foreach(const T &part, message)
+		{
+			put32(p, part.size());
+			p += 4;
+		}
+
+		foreach(const T &part, message)
+		{
+			memcpy(p, part.data(), part.size());
+			p += part.size();
+		}
+
+		memset(p, 0, buf.data() + size - p);
+
+		file.write(buf.data(), size);
+	}
+};
+
+Capture::Capture()
+{
+	d = new Private;
+}
+
+Capture::~Capture()
+{
+	close();
+	delete d;
+}
+
+bool Capture::open(const QString &fileName)
+{
+	close();
+
+	d->file.setFileName(fileName);
+	if(!d->file.open(QFile::ReadWrite))
+		return false;
+
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	if(d->file.size() > 0)
+	{
+		// anything that isn't a capture file is left alone
+		QByteArray header = d->file.read(FileHeaderSize);
+		if(header.size() != FileHeaderSize || memcmp(header.data(), Magic, 8) != 0)
+		{
+			d->file.close();
+			return false;
+		}
+
+		qint64 startTime = get64((const uchar *)header.data() + 8);
+		d->timeOffset = (now - startTime) * 1000000;
+
+		// drop any partly written record at the end
+		qint64 pos = FileHeaderSize;
+		while(pos + RecordHeaderSize <= d->file.size())
+		{
+			if(!d->file.seek(pos + 8))
+				break;
+
+			QByteArray sizeBuf = d->file.read(4);
+			if(sizeBuf.size() != 4)
+				break;
+
+			quint32 size = get32((const uchar *)sizeBuf.data());
+			if(size < (quint32)RecordHeaderSize || pos + size > d->file.size())
+				break;
+
+			pos += size;
+		}
+
+		d->file.resize(pos);
+		d->file.seek(pos);
+	}
+	else
+	{
+		char header[FileHeaderSize];
+		memset(header, 0, FileHeaderSize);
+		memcpy(header, Magic, 7);
+		put64(header + 8, now);
+		d->file.write(header, FileHeaderSize);
+
+		d->timeOffset = 0;
+	}
+
+	d->clock.start();
+	return true;
+}
+
+void Capture::close()
+{
+	if(d->file.isOpen())
+		d->file.close();
+}
+
+bool Capture::isOpen() const
+{
+	return d->file.isOpen();
+}
+
+void Capture::setDirections(int directions)
+{
+	d->directions = directions;
+}
+
+void Capture::record(Direction direction, const QList<QByteArray> &message)
+{
+	d->record(direction, message);
+}
+
+void Capture::record(Direction direction, const QList<Frame> &message)
+{
+	d->record(direction, message);
+}
+
+void Capture::flush()
+{
+	if(d->file.isOpen())
+		d->file.flush();
+}
+
+class CaptureReader::Private
+{
+public:
+	QFile file;
+	const uchar *data;
+	qint64 size;
+	qint64 pos;
+
+	Private() :
+		data(0),
+		size(0),
+		pos(0)
+	{
+	}
+};
+
+CaptureReader::CaptureReader()
+{
+	d = new Private;
+}
+
+CaptureReader::~CaptureReader()
+{
+	close();
+	delete d;
+}
+
+bool CaptureReader::open(const QString &fileName)
+{
+	close();
+
+	d->file.setFileName(fileName);
+	if(!d->file.open(QFile::ReadOnly))
+		return false;
+
+	d->size = d->file.size();
+	if(d->size < FileHeaderSize)
+	{
+		close();
+		return false;
+	}
+
+	d->data = d->file.map(0, d->size);
+	if(!d->data || memcmp(d->data, Magic, 8) != 0)
+	{
+		close();
+		return false;
+	}
+
+	d->pos = FileHeaderSize;
+	return true;
+}
+
+void CaptureReader::close()
+{
+	if(d->data)
+	{
+		d->file.unmap((uchar *)d->data);
+		d->data = 0;
+	}
+
+	if(d->file.isOpen())
+		d->file.close();
+
+	d->size = 0;
+	d->pos = 0;
+}
+
+qint64 CaptureReader::startTime() const
+{
+	if(!d->data)
+		return 0;
+
+	return get64(d->data + 8);
+}
+
+bool CaptureReader::atEnd() const
+{
+	return (!d->data || d->pos + RecordHeaderSize > d->size);
+}
+
+bool CaptureReader::readNext(Record *record)
+{
+	if(atEnd())
+		return false;
+
+	const uchar *p = d->data + d->pos;
+	quint32 size = get32(p + 8);
+	quint32 count = get32(p + 16);
+
+	if(size < (quint32)RecordHeaderSize || d->pos + size > d->size || (qint64)count * 4 > size - RecordHeaderSize)
+	{
+		// damaged. treat as the end
+		d->pos = d->size;
+		return false;
+	}
+
+	record->time = get64(p);
+	record->direction = (Capture::Direction)get32(p + 12);
+	record->message.clear();
+
+	const uchar *sizes = p + RecordHeaderSize;
+	const uchar *frameData = sizes + count * 4;
+	const uchar *end = p + size;
+
+	for(quint32 n = 0; n < count; ++n)
+	{
+		quint32 frameSize = get32(sizes + n * 4);
+		if(frameSize > (quint32)(end - frameData))
+		{
+			d->pos = d->size;
+			return false;
+		}
+
+		record->message += QByteArray::fromRawData((const char *)frameData, frameSize);
+		frameData += frameSize;
+	}
+
+	d->pos += size;
+	return true;
+}
+
+void CaptureReader::rewind()
+{
+	if(d->data)
+		d->pos = FileHeaderSize;
+}
+
+}
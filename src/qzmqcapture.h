@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQCAPTURE_H
+#define QZMQCAPTURE_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include "qzmqframe.h"
+
+namespace QZmq {
+
+// records messages into an append-only file, for later replay or
+//   analysis. attach to sockets with Socket::setCapture. not thread-safe,
+//   so sockets sharing a capture must live in the same thread.
+//
+// file format, little endian: a 16 byte header of "QZMQCAP" plus a zero
+//   byte and the capture start time in msecs since the epoch (int64),
+//   followed by records. each record is: time in nsecs since the capture
+//   start (int64), record size in bytes (uint32), direction (uint32),
+//   frame count (uint32), reserved (uint32), the size of each frame
+//   (uint32 each), the frame data, then padding to a multiple of 8 bytes.
+//   records are thus 8-byte aligned when the file is memory mapped
+class Capture
+{
+public:
+	enum Direction
+	{
+		Read = 0x01,
+		Written = 0x02
+	};
+
+	Capture();
+	~Capture();
+
+	// appends to the file if it already exists. returns false if the file
+	//   is not empty and isn't a capture file
+	bool open(const QString &fileName);
+	void close();
+	bool isOpen() const;
+
+	// which directions to record (default = Read | Written)
+	void setDirections(int directions);
+
+	// messages too big for a record (2GB) are not recorded
+	void record(Direction direction, const QList<QByteArray> &message);
+	void record(Direction direction, const QList<Frame> &message);
+
+	void flush();
+
+private:
+	Q_DISABLE_COPY(Capture)
+
+	class Private;
+	Private *d;
+};
+
+// reads a capture file by memory mapping it. frames are returned as views
+//   into the mapping (see QByteArray::fromRawData), so they are only
+//   valid while the reader is open, and must be copied to be kept
+class CaptureReader
+{
+public:
+	class Record
+	{
+	public:
+		qint64 time;
+		Capture::Direction direction;
+		QList<QByteArray> message;
+	};
+
+	CaptureReader();
+	~CaptureReader();
+
+	bool open(const QString &fileName);
+	void close();
+
+	// capture start time, in msecs since the epoch
+	qint64 startTime() const;
+
+	bool atEnd() const;
+
+	// returns false at the end, or if the rest of the file is damaged
+	bool readNext(Record *record);
+
+	// go back to the first record
+	void rewind();
+
+private:
+	Q_DISABLE_COPY(CaptureReader)
+
+	class Private;
+	Private *d;
+};
+
+}
+
+#endif
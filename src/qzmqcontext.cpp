@@ -26,12 +26,25 @@
 #include <assert.h>
 #include <zmq.h>
 
+#if (ZMQ_VERSION_MAJOR >= 4) || ((ZMQ_VERSION_MAJOR >= 3) && (ZMQ_VERSION_MINOR >= 2))
+# define USE_CTX_SET
+#endif
+
 namespace QZmq {
 
+static Context::Options *g_globalOptions = 0;
+static Context::GlobalPolicy g_globalPolicy = Context::ReleaseWhenUnused;
+
 Context::Context(int ioThreads)
 {
-	context_ = zmq_init(ioThreads);
-	assert(context_);
+	Options options;
+	options.ioThreads = ioThreads;
+	init(options);
+}
+
+Context::Context(const Options &options)
+{
+	init(options);
 }
 
 Context::~Context()
@@ -39,4 +52,78 @@ Context::~Context()
 	zmq_term(context_);
 }
 
+void Context::init(const Options &options)
+{
+#ifdef USE_CTX_SET
+	context_ = zmq_ctx_new();
+	assert(context_);
+
+	// these must all be set before the first socket is created, since
+	//   that's when libzmq starts its i/o threads
+	int ret = zmq_ctx_set(context_, ZMQ_IO_THREADS, options.ioThreads);
+	assert(ret == 0);
+
+	if(options.maxSockets != -1)
+	{
+		ret = zmq_ctx_set(context_, ZMQ_MAX_SOCKETS, options.maxSockets);
+		assert(ret == 0);
+	}
+
+# ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+	foreach(int cpu, options.ioThreadCpus)
+	{
+		ret = zmq_ctx_set(context_, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu);
+		assert(ret == 0);
+	}
+# endif
+
+# ifdef ZMQ_THREAD_SCHED_POLICY
+	if(options.ioThreadSchedPolicy != -1)
+	{
+		ret = zmq_ctx_set(context_, ZMQ_THREAD_SCHED_POLICY, options.ioThreadSchedPolicy);
+		assert(ret == 0);
+	}
+# endif
+
+# ifdef ZMQ_THREAD_PRIORITY
+	if(options.ioThreadPriority != -1)
+	{
+		ret = zmq_ctx_set(context_, ZMQ_THREAD_PRIORITY, options.ioThreadPriority);
+		assert(ret == 0);
+	}
+# endif
+
+	Q_UNUSED(ret);
+#else
+	context_ = zmq_init(options.ioThreads);
+	assert(context_);
+#endif
+}
+
+void Context::setGlobalOptions(const Options &options)
+{
+	if(!g_globalOptions)
+		g_globalOptions = new Options;
+
+	*g_globalOptions = options;
+}
+
+Context::Options Context::globalOptions()
+{
+	if(g_globalOptions)
+		return *g_globalOptions;
+	else
+		return Options();
+}
+
+void Context::setGlobalPolicy(GlobalPolicy policy)
+{
+	g_globalPolicy = policy;
+}
+
+Context::GlobalPolicy Context::globalPolicy()
+{
+	return g_globalPolicy;
+}
+
 }
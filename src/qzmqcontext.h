@@ -24,19 +24,76 @@
 #ifndef QZMQCONTEXT_H
 #define QZMQCONTEXT_H
 
+#include <QList>
+
 namespace QZmq {
 
 class Context
 {
 public:
+	// options that are only available with newer versions of libzmq are
+	//   ignored when not supported
+	class Options
+	{
+	public:
+		int ioThreads;
+
+		// -1 means libzmq default
+		int maxSockets;
+
+		// cpus the libzmq i/o threads may run on. empty means any
+		QList<int> ioThreadCpus;
+
+		// scheduling policy and priority of the i/o threads, as in
+		//   sched_setscheduler(). -1 means unchanged
+		int ioThreadSchedPolicy;
+		int ioThreadPriority;
+
+		Options() :
+			ioThreads(1),
+			maxSockets(-1),
+			ioThreadSchedPolicy(-1),
+			ioThreadPriority(-1)
+		{
+		}
+	};
+
 	Context(int ioThreads = 1);
+	Context(const Options &options);
 	~Context();
 
+	enum GlobalPolicy
+	{
+		// one context, destroyed along with the last socket using it, and
+		//   created again as needed
+		ReleaseWhenUnused,
+
+		// one context, created on first use and kept for the life of the
+		//   process. this avoids context churn and locking when sockets
+		//   come and go at high rates
+		KeepAlive,
+
+		// one context per thread, created on first use in the thread and
+		//   released once the thread has ended and none of the sockets
+		//   created in it remain
+		PerThread
+	};
+
+	// options and policy for the context that sockets use when not given
+	//   one. must be set before the first such socket is created
+	//   (default policy = ReleaseWhenUnused)
+	static void setGlobalOptions(const Options &options);
+	static Options globalOptions();
+	static void setGlobalPolicy(GlobalPolicy policy);
+	static GlobalPolicy globalPolicy();
+
 	// the zmq context
 	void *context() { return context_; }
 
 private:
 	void *context_;
+
+	void init(const Options &options);
 };
 
 }
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqframe.h"
+
+#include <assert.h>
+#include <zmq.h>
+
+namespace QZmq {
+
+class Frame::Private : public QSharedData
+{
+public:
+	zmq_msg_t msg;
+
+	Private()
+	{
+		int ret = zmq_msg_init(&msg);
+		assert(ret == 0);
+	}
+
+	~Private()
+	{
+		int ret = zmq_msg_close(&msg);
+		assert(ret == 0);
+	}
+
+private:
+	Q_DISABLE_COPY(Private)
+};
+
+Frame::Frame()
+{
+}
+
+Frame::Frame(const Frame &from) :
+	d(from.d)
+{
+}
+
+Frame::~Frame()
+{
+}
+
+Frame & Frame::operator=(const Frame &from)
+{
+	d = from.d;
+	return *this;
+}
+
+bool Frame::isNull() const
+{
+	return !d;
+}
+
+bool Frame::isEmpty() const
+{
+	return (size() == 0);
+}
+
+int Frame::size() const
+{
+	if(!d)
+		return 0;
+
+	return (int)zmq_msg_size(&d->msg);
+}
+
+const char *Frame::data() const
+{
+	if(!d)
+		return 0;
+
+	return (const char *)zmq_msg_data(&d->msg);
+}
+
+QByteArray Frame::toByteArray() const
+{
+	return QByteArray(data(), size());
+}
+
+QByteArray Frame::toRawData() const
+{
+	return QByteArray::fromRawData(data(), size());
+}
+
+void *Frame::message() const
+{
+	if(!d)
+		return 0;
+
+	return &d->msg;
+}
+
+Frame Frame::fromMessage(void *msg)
+{
+	Frame f;
+	f.d = new Private;
+
+	int ret = zmq_msg_move(&f.d->msg, (zmq_msg_t *)msg);
+	assert(ret == 0);
+
+	return f;
+}
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQFRAME_H
+#define QZMQFRAME_H
+
+#include <QByteArray>
+#include <QExplicitlySharedDataPointer>
+
+namespace QZmq {
+
+// a single message part as received from zmq. the underlying zmq_msg_t is
+//   kept alive for as long as any copy of the Frame exists, so the data can
+//   be accessed without copying it out. frames are immutable and copies are
+//   cheap.
+class Frame
+{
+public:
+	Frame();
+	Frame(const Frame &from);
+	~Frame();
+	Frame & operator=(const Frame &from);
+
+	bool isNull() const;
+	bool isEmpty() const;
+
+	int size() const;
+	const char *data() const;
+
+	// returns a deep copy of the data
+	QByteArray toByteArray() const;
+
+	// returns a QByteArray that refers to the frame data without copying
+	//   it. it is only valid for as long as this frame (or a copy of it)
+	//   exists
+	QByteArray toRawData() const;
+
+	// the zmq_msg_t, for use with the C API. it must not be modified
+	void *message() const;
+
+	// takes over the content of msg, a zmq_msg_t, without copying. msg is
+	//   left empty, as if initialized with zmq_msg_init
+	static Frame fromMessage(void *msg);
+
+private:
+	class Private;
+	QExplicitlySharedDataPointer<Private> d;
+};
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqlatencyhistogram.h"
+
+namespace QZmq {
+
+static const int SubBucketBits = 5;
+static const int SubBucketCount = 1 << SubBucketBits;
+
+// one set of sub-buckets for the values below SubBucketCount * 2, then
+//   one set for each further power of two a qint64 can hold
+static const int BucketCount = (64 - SubBucketBits) * SubBucketCount;
+
+static int bucketIndex(qint64 value)
+{
+	quint64 v = (quint64)value;
+
+	int shift = 0;
+	while(v >= (quint64)(SubBucketCount * 2))
+	{
+		v >>= 1;
+		++shift;
+	}
+
+	// v is now in [0, SubBucketCount * 2)
+	return shift * SubBucketCount + (int)v;
+}
+
+static qint64 bucketHighestValue(int index)
+{
+	if(index < SubBucketCount * 2)
+		return index;
+
+	int shift = index / SubBucketCount - 1;
+	qint64 v = (qint64)(SubBucketCount + index % SubBucketCount) << shift;
+	return v + ((qint64)1 << shift) - 1;
+}
+
+LatencyHistogram::LatencyHistogram() :
+	count_(0),
+	min_(0),
+	max_(0),
+	total_(0)
+{
+}
+
+void LatencyHistogram::record(qint64 value)
+{
+	if(value < 0)
+		value = 0;
+
+	// allocated on first use, so that unused histograms are cheap to copy
+	if(counts_.isEmpty())
+		counts_.fill(0, BucketCount);
+
+	++counts_[bucketIndex(value)];
+
+	if(count_ == 0 || value < min_)
+		min_ = value;
+	if(value > max_)
+		max_ = value;
+
+	++count_;
+	total_ += value;
+}
+
+void LatencyHistogram::reset()
+{
+	counts_.clear();
+	count_ = 0;
+	min_ = 0;
+	max_ = 0;
+	total_ = 0;
+}
+
+double LatencyHistogram::mean() const
+{
+	if(count_ == 0)
+		return 0;
+
+	return total_ / count_;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const
+{
+	if(count_ == 0)
+		return 0;
+
+	qint64 target = (qint64)((qBound(0.0, percent, 100.0) / 100.0) * count_ + 0.5);
+	target = qBound((qint64)1, target, count_);
+
+	qint64 seen = 0;
+	for(int n = 0; n < counts_.count(); ++n)
+	{
+		seen += counts_[n];
+		if(seen >= target)
+			return qMin(bucketHighestValue(n), max_);
+	}
+
+	return max_;
+}
+
+QList< QPair<qint64, qint64> > LatencyHistogram::buckets() const
+{
+	QList< QPair<qint64, qint64> > out;
+	for(int n = 0; n < counts_.count(); ++n)
+	{
+		if(counts_[n] > 0)
+			out += QPair<qint64, qint64>(qMin(bucketHighestValue(n), max_), counts_[n]);
+	}
+
+	return out;
+}
+
+LatencyHistogram & LatencyHistogram::operator+=(const LatencyHistogram &other)
+{
+	if(other.count_ == 0)
+		return *this;
+
+	if(counts_.isEmpty())
+		counts_.fill(0, BucketCount);
+
+	for(int n = 0; n < other.counts_.count(); ++n)
+		counts_[n] += other.counts_[n];
+
+	if(count_ == 0 || other.min_ < min_)
+		min_ = other.min_;
+	if(other.max_ > max_)
+		max_ = other.max_;
+
+	count_ += other.count_;
+	total_ += other.total_;
+
+	return *this;
+}
+
+}
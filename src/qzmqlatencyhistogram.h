@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQLATENCYHISTOGRAM_H
+#define QZMQLATENCYHISTOGRAM_H
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+namespace QZmq {
+
+// records values into log-linear buckets, in the style of HdrHistogram.
+//   each power of two is split into 32 linear buckets, so reported values
+//   are within about 3% of the recorded ones, using a fixed amount of
+//   memory regardless of range
+class LatencyHistogram
+{
+public:
+	LatencyHistogram();
+
+	void record(qint64 value);
+	void reset();
+
+	qint64 count() const { return count_; }
+	qint64 min() const { return count_ > 0 ? min_ : 0; }
+	qint64 max() const { return max_; }
+	double mean() const;
+
+	// the value at or below which the given percentage (0-100) of the
+	//   recorded values fall
+	qint64 percentile(double percent) const;
+
+	// non-empty buckets, as pairs of the highest value in the bucket and
+	//   the number of values recorded in it, in increasing order
+	QList< QPair<qint64, qint64> > buckets() const;
+
+	LatencyHistogram & operator+=(const LatencyHistogram &other);
+
+private:
+	QVector<qint64> counts_;
+	qint64 count_;
+	qint64 min_;
+	qint64 max_;
+	double total_;
+};
+
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqmonitor.h"
+
+#include <string.h>
+#include <assert.h>
+#include <QPointer>
+#include <QHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <zmq.h>
+#include "qzmqsocket.h"
+
+namespace QZmq {
+
+static QAtomicInt g_monitorId;
+
+class Monitor::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	Monitor *q;
+	QPointer<Socket> target;
+	Socket *pair;
+	Metrics metrics;
+
+	// when each endpoint was last disconnected, by the monotonic clock
+	QHash<QString, qint64> disconnectedAt;
+	QElapsedTimer clock;
+
+	Private(Monitor *_q, Socket *sock) :
+		QObject(_q),
+		q(_q),
+		target(sock),
+		pair(0)
+	{
+		clock.start();
+
+#if ZMQ_VERSION_MAJOR >= 4
+		QByteArray addr = "inproc://qzmq-monitor-" + QByteArray::number(g_monitorId.fetchAndAddOrdered(1));
+
+		int ret = zmq_socket_monitor(sock->zmqSocket(), addr.data(), ZMQ_EVENT_ALL);
+		assert(ret == 0);
+
+		pair = sock->createPeer(Socket::Pair, this);
+		pair->setShutdownWaitTime(0);
+		connect(pair, SIGNAL(readyRead()), SLOT(pair_readyRead()));
+		pair->connectToAddress(QString::fromLatin1(addr));
+#endif
+	}
+
+	~Private()
+	{
+		stop();
+	}
+
+	void stop()
+	{
+		if(!pair)
+			return;
+
+		if(target)
+			zmq_socket_monitor(target->zmqSocket(), 0, 0);
+
+		delete pair;
+		pair = 0;
+	}
+
+	// returns false if monitoring has stopped
+	bool handleEvent(const QList<QByteArray> &message)
+	{
+		// first part holds the event number and value, second the
+		//   endpoint address
+		if(message.count() < 2 || message[0].size() < 6)
+			return true;
+
+		quint16 event;
+		quint32 value;
+		memcpy(&event, message[0].data(), 2);
+		memcpy(&value, message[0].data() + 2, 4);
+
+		QString endpoint = QString::fromUtf8(message[1]);
+		qint64 time = QDateTime::currentMSecsSinceEpoch();
+
+		switch(event)
+		{
+			case ZMQ_EVENT_CONNECTED:
+			{
+				++metrics.connects;
+
+				qint64 downtime = -1;
+				if(disconnectedAt.contains(endpoint))
+				{
+					downtime = clock.elapsed() - disconnectedAt.take(endpoint);
+					metrics.reconnectTimes.record(downtime);
+				}
+
+				QPointer<QObject> self = this;
+
+				emit q->connected(endpoint, time);
+				if(!self)
+					return false;
+
+				if(downtime >= 0)
+					emit q->reconnected(endpoint, downtime, time);
+				break;
+			}
+			case ZMQ_EVENT_CONNECT_DELAYED:
+				emit q->connectDelayed(endpoint, time);
+				break;
+			case ZMQ_EVENT_CONNECT_RETRIED:
+				++metrics.connectRetries;
+				emit q->connectRetried(endpoint, (int)value, time);
+				break;
+			case ZMQ_EVENT_LISTENING:
+				emit q->listening(endpoint, time);
+				break;
+			case ZMQ_EVENT_BIND_FAILED:
+				++metrics.failures;
+				emit q->bindFailed(endpoint, (int)value, time);
+				break;
+			case ZMQ_EVENT_ACCEPTED:
+				++metrics.accepts;
+				emit q->accepted(endpoint, time);
+				break;
+			case ZMQ_EVENT_ACCEPT_FAILED:
+				++metrics.failures;
+				emit q->acceptFailed(endpoint, (int)value, time);
+				break;
+			case ZMQ_EVENT_CLOSED:
+				++metrics.closes;
+				emit q->closed(endpoint, time);
+				break;
+			case ZMQ_EVENT_DISCONNECTED:
+				++metrics.disconnects;
+				if(!disconnectedAt.contains(endpoint))
+					disconnectedAt.insert(endpoint, clock.elapsed());
+				emit q->disconnected(endpoint, time);
+				break;
+			case ZMQ_EVENT_MONITOR_STOPPED:
+				return false;
+#ifdef ZMQ_EVENT_HANDSHAKE_FAILED_NO_DETAIL
+			case ZMQ_EVENT_HANDSHAKE_FAILED_NO_DETAIL:
+			case ZMQ_EVENT_HANDSHAKE_FAILED_PROTOCOL:
+			case ZMQ_EVENT_HANDSHAKE_FAILED_AUTH:
+				++metrics.failures;
+				emit q->handshakeFailed(endpoint, (int)value, time);
+				break;
+#endif
+#ifdef ZMQ_EVENT_HANDSHAKE_SUCCEEDED
+			case ZMQ_EVENT_HANDSHAKE_SUCCEEDED:
+				emit q->handshakeSucceeded(endpoint, time);
+				break;
+#endif
+			default:
+				break;
+		}
+
+		return true;
+	}
+
+private slots:
+	void pair_readyRead()
+	{
+		QPointer<QObject> self = this;
+
+		while(pair->canRead())
+		{
+			QList<QByteArray> message = pair->read();
+			if(message.isEmpty())
+				break;
+
+			bool ok = handleEvent(message);
+			if(!self)
+				return;
+
+			if(!ok)
+			{
+				// the monitored socket is gone
+				pair->deleteLater();
+				pair = 0;
+				return;
+			}
+		}
+	}
+};
+
+Monitor::Monitor(Socket *sock, QObject *parent) :
+	QObject(parent)
+{
+	d = new Private(this, sock);
+}
+
+Monitor::~Monitor()
+{
+	delete d;
+}
+
+bool Monitor::isActive() const
+{
+	return (d->pair != 0);
+}
+
+Monitor::Metrics Monitor::metrics() const
+{
+	return d->metrics;
+}
+
+void Monitor::resetMetrics()
+{
+	d->metrics = Metrics();
+}
+
+}
+
+#include "qzmqmonitor.moc"
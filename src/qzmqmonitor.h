@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQMONITOR_H
+#define QZMQMONITOR_H
+
+#include <QObject>
+#include "qzmqlatencyhistogram.h"
+
+namespace QZmq {
+
+class Socket;
+
+// observes the connection events of a socket, using zmq_socket_monitor.
+//   events are read from the monitor pair socket like any other socket
+//   input, and reported as signals. times are msecs since the epoch, as
+//   of when the event was read. requires zmq 4.x or later
+class Monitor : public QObject
+{
+	Q_OBJECT
+
+public:
+	class Metrics
+	{
+	public:
+		int connects;
+		int disconnects;
+		int connectRetries;
+		int accepts;
+		int closes;
+		int failures;
+
+		// time from a disconnect until the same endpoint was connected
+		//   again, in msecs
+		LatencyHistogram reconnectTimes;
+
+		Metrics() :
+			connects(0),
+			disconnects(0),
+			connectRetries(0),
+			accepts(0),
+			closes(0),
+			failures(0)
+		{
+		}
+	};
+
+	// the socket must outlive the monitor, or be destroyed in the same
+	//   thread. monitoring stops when either goes away
+	Monitor(Socket *sock, QObject *parent = 0);
+	~Monitor();
+
+	// returns false if monitoring isn't supported by the zmq version
+	bool isActive() const;
+
+	Metrics metrics() const;
+	void resetMetrics();
+
+signals:
+	void connected(const QString &endpoint, qint64 time);
+	void connectDelayed(const QString &endpoint, qint64 time);
+	void connectRetried(const QString &endpoint, int intervalMsecs, qint64 time);
+	void listening(const QString &endpoint, qint64 time);
+	void bindFailed(const QString &endpoint, int error, qint64 time);
+	void accepted(const QString &endpoint, qint64 time);
+	void acceptFailed(const QString &endpoint, int error, qint64 time);
+	void closed(const QString &endpoint, qint64 time);
+	void disconnected(const QString &endpoint, qint64 time);
+	void handshakeFailed(const QString &endpoint, int error, qint64 time);
+	void handshakeSucceeded(const QString &endpoint, qint64 time);
+
+	// an endpoint was connected again after a disconnect
+	void reconnected(const QString &endpoint, qint64 downtimeMsecs, qint64 time);
+
+private:
+	Q_DISABLE_COPY(Monitor)
+
+	class Private;
+	friend class Private;
+	Private *d;
+};
+
+}
+
+#endif
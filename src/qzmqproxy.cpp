@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqproxy.h"
+
+#include "qzmqsocket.h"
+
+namespace QZmq {
+
+class Proxy::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	class Direction
+	{
+	public:
+		Socket *src;
+		Socket *dest;
+		bool paused;
+
+		Direction() :
+			src(0),
+			dest(0),
+			paused(false)
+		{
+		}
+	};
+
+	Proxy *q;
+	Direction forward;
+	Direction backward;
+	Socket *capture;
+	bool active;
+	bool pendingForward;
+	int maxMessagesPerEvent;
+
+	Private(Proxy *_q, Socket *frontend, Socket *backend) :
+		QObject(_q),
+		q(_q),
+		capture(0),
+		active(false),
+		pendingForward(false),
+		maxMessagesPerEvent(100)
+	{
+		forward.src = frontend;
+		forward.dest = backend;
+		backward.src = backend;
+		backward.dest = frontend;
+
+		connect(frontend, SIGNAL(readyRead()), SLOT(sock_readyRead()));
+		connect(frontend, SIGNAL(messagesWritten(int)), SLOT(frontend_messagesWritten(int)));
+		connect(backend, SIGNAL(readyRead()), SLOT(sock_readyRead()));
+		connect(backend, SIGNAL(messagesWritten(int)), SLOT(backend_messagesWritten(int)));
+	}
+
+	void queueForward()
+	{
+		if(pendingForward)
+			return;
+
+		pendingForward = true;
+		QMetaObject::invokeMethod(this, "queuedForward", Qt::QueuedConnection);
+	}
+
+	// returns false if the budget ran out
+	bool tryForward(Direction *dir, int *count)
+	{
+		while(active && !dir->paused && dir->src->canRead())
+		{
+			if(*count >= maxMessagesPerEvent)
+				return false;
+
+			QList<Frame> message = dir->src->readFrames();
+			++(*count);
+
+			if(message.isEmpty())
+				continue;
+
+			if(capture)
+				capture->writeFrames(message);
+
+			dir->dest->writeFrames(message);
+
+			// stop reading once the destination is backed up. we'll
+			//   continue once it reports progress
+			if(!dir->dest->canWriteImmediately())
+				dir->paused = true;
+		}
+
+		return true;
+	}
+
+	void tryForwardAll()
+	{
+		int count = 0;
+		if(!tryForward(&forward, &count) || !tryForward(&backward, &count))
+			queueForward();
+	}
+
+public slots:
+	void sock_readyRead()
+	{
+		if(pendingForward)
+			return;
+
+		tryForwardAll();
+	}
+
+	void frontend_messagesWritten(int count)
+	{
+		Q_UNUSED(count);
+
+		backward.paused = false;
+		if(!pendingForward)
+			tryForwardAll();
+	}
+
+	void backend_messagesWritten(int count)
+	{
+		Q_UNUSED(count);
+
+		forward.paused = false;
+		if(!pendingForward)
+			tryForwardAll();
+	}
+
+	void queuedForward()
+	{
+		pendingForward = false;
+		tryForwardAll();
+	}
+};
+
+Proxy::Proxy(Socket *frontend, Socket *backend, QObject *parent) :
+	QObject(parent)
+{
+	d = new Private(this, frontend, backend);
+}
+
+Proxy::~Proxy()
+{
+	delete d;
+}
+
+void Proxy::setCapture(Socket *capture)
+{
+	d->capture = capture;
+	if(d->capture)
+		d->capture->setWriteQueueEnabled(false);
+}
+
+void Proxy::setMaxMessagesPerEvent(int max)
+{
+	d->maxMessagesPerEvent = max;
+}
+
+void Proxy::start()
+{
+	if(!d->active)
+	{
+		d->active = true;
+		d->queueForward();
+	}
+}
+
+void Proxy::stop()
+{
+	d->active = false;
+}
+
+}
+
+#include "qzmqproxy.moc"
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQPROXY_H
+#define QZMQPROXY_H
+
+#include <QObject>
+
+namespace QZmq {
+
+class Socket;
+
+// forwards messages in both directions between two sockets, like
+//   zmq_proxy, but driven by the event loop. frames are passed along
+//   without copying, and reading from one side is paused while the other
+//   side can't accept more. the sockets should have their write queues
+//   enabled (the default), and aren't owned by the proxy
+class Proxy : public QObject
+{
+	Q_OBJECT
+
+public:
+	Proxy(Socket *frontend, Socket *backend, QObject *parent = 0);
+	~Proxy();
+
+	// if set, every forwarded message is also written to this socket.
+	//   the capture socket's write queue is disabled, so that messages it
+	//   can't take are dropped rather than queued
+	void setCapture(Socket *capture);
+
+	void setMaxMessagesPerEvent(int max);
+
+	void start();
+	void stop();
+
+private:
+	class Private;
+	friend class Private;
+	Private *d;
+};
+
+}
+
+#endif
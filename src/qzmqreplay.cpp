@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqreplay.h"
+
+#include <QTimer>
+#include <QElapsedTimer>
+#include "qzmqsocket.h"
+#include "qzmqcapture.h"
+
+namespace QZmq {
+
+// how long to wait before retrying a refused write, in milliseconds
+static const int RetryInterval = 10;
+
+class Replay::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	Replay *q;
+	Socket *sock;
+	CaptureReader reader;
+	bool opened;
+	double speed;
+	int directions;
+	bool active;
+	bool waitingForRoom;
+	int replayed;
+	bool haveNext;
+	CaptureReader::Record next;
+	qint64 firstTime;
+	QElapsedTimer clock;
+	QTimer *timer;
+
+	Private(Replay *_q, Socket *_sock) :
+		QObject(_q),
+		q(_q),
+		sock(_sock),
+		opened(false),
+		speed(1.0),
+		directions(Capture::Read),
+		active(false),
+		waitingForRoom(false),
+		replayed(0),
+		haveNext(false),
+		firstTime(0)
+	{
+		connect(sock, SIGNAL(messagesWritten(int)), SLOT(sock_room()));
+		connect(sock, SIGNAL(writeQueueLow()), SLOT(sock_room()));
+
+		timer = new QTimer(this);
+		connect(timer, SIGNAL(timeout()), SLOT(timer_timeout()));
+		timer->setSingleShot(true);
+		timer->setTimerType(Qt::PreciseTimer);
+	}
+
+	~Private()
+	{
+		timer->disconnect(this);
+		timer->setParent(0);
+		timer->deleteLater();
+	}
+
+	// loads the next record to replay. frames are copied out of the
+	//   mapping, since the socket may hold on to them
+	void loadNext()
+	{
+		CaptureReader::Record r;
+		while(reader.readNext(&r))
+		{
+			if(!(directions & r.direction) || r.message.isEmpty())
+				continue;
+
+			next.time = r.time;
+			next.direction = r.direction;
+			next.message.clear();
+			foreach(const QByteArray &buf, r.message)
+				next.message += QByteArray(buf.constData(), buf.size());
+
+			haveNext = true;
+			return;
+		}
+
+		haveNext = false;
+	}
+
+	void start()
+	{
+		if(!opened)
+			return;
+
+		stop();
+
+		reader.rewind();
+		replayed = 0;
+		loadNext();
+
+		active = true;
+		firstTime = (haveNext ? next.time : 0);
+		clock.start();
+
+		// start from the event loop, so finished can't be emitted from
+		//   within start
+		timer->start(0);
+	}
+
+	void stop()
+	{
+		active = false;
+		waitingForRoom = false;
+		timer->stop();
+	}
+
+	void replay()
+	{
+		int count = 0;
+		while(haveNext)
+		{
+			if(speed > 0)
+			{
+				qint64 due = (qint64)((next.time - firstTime) / speed);
+				qint64 now = clock.nsecsElapsed();
+				if(due > now)
+				{
+					timer->start((int)((due - now) / 1000000));
+					return;
+				}
+			}
+
+			if(!sock->write(next.message))
+			{
+				// continue once the socket has room. with the write queue
+				//   disabled there is no signal for that, so also retry
+				//   after a short while
+				waitingForRoom = true;
+				timer->start(RetryInterval);
+				return;
+			}
+
+			++replayed;
+			loadNext();
+
+			// let other things run now and then when behind
+			if(++count >= 1000)
+			{
+				timer->start(0);
+				return;
+			}
+		}
+
+		active = false;
+		emit q->finished();
+	}
+
+private slots:
+	void timer_timeout()
+	{
+		if(!active)
+			return;
+
+		waitingForRoom = false;
+		replay();
+	}
+
+	void sock_room()
+	{
+		if(!active || !waitingForRoom)
+			return;
+
+		waitingForRoom = false;
+		timer->stop();
+		replay();
+	}
+};
+
+Replay::Replay(Socket *sock, QObject *parent) :
+	QObject(parent)
+{
+	d = new Private(this, sock);
+}
+
+Replay::~Replay()
+{
+	delete d;
+}
+
+bool Replay::open(const QString &fileName)
+{
+	d->stop();
+	d->opened = d->reader.open(fileName);
+	return d->opened;
+}
+
+void Replay::setSpeed(double speed)
+{
+	d->speed = speed;
+}
+
+void Replay::setDirections(int directions)
+{
+	d->directions = directions;
+}
+
+void Replay::start()
+{
+	d->start();
+}
+
+void Replay::stop()
+{
+	d->stop();
+}
+
+bool Replay::isActive() const
+{
+	return d->active;
+}
+
+int Replay::replayedCount() const
+{
+	return d->replayed;
+}
+
+}
+
+#include "qzmqreplay.moc"
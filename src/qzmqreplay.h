@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQREPLAY_H
+#define QZMQREPLAY_H
+
+#include <QObject>
+
+namespace QZmq {
+
+class Socket;
+
+// writes the messages of a capture file to a socket, paced as recorded
+//   or faster. messages are written as recorded, including any routing
+//   envelope. when the socket refuses a write (see
+//   Socket::setWriteQueueLimits, or a disabled write queue), replay waits
+//   for room and retries rather than dropping, so the same messages are
+//   always sent in the same order
+class Replay : public QObject
+{
+	Q_OBJECT
+
+public:
+	Replay(Socket *sock, QObject *parent = 0);
+	~Replay();
+
+	bool open(const QString &fileName);
+
+	// 1.0 replays at the recorded pace, 2.0 twice as fast, and so on. 0
+	//   means as fast as the socket takes messages (default = 1.0)
+	void setSpeed(double speed);
+
+	// which recorded directions to replay. typically the messages a
+	//   server read, written from a client socket to reproduce the load
+	//   (default = Capture::Read)
+	void setDirections(int directions);
+
+	void start();
+	void stop();
+
+	bool isActive() const;
+	int replayedCount() const;
+
+signals:
+	void finished();
+
+private:
+	Q_DISABLE_COPY(Replay)
+
+	class Private;
+	friend class Private;
+	Private *d;
+};
+
+}
+
+#endif
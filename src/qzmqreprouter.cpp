@@ -73,6 +73,16 @@ void RepRouter::setShutdownWaitTime(int msecs)
 	d->sock->setShutdownWaitTime(msecs);
 }
 
+void RepRouter::setPeerQueuesEnabled(bool enable)
+{
+	d->sock->setRouterPeerQueuesEnabled(enable);
+}
+
+void RepRouter::setPeerQueueLimit(int maxMessages)
+{
+	d->sock->setRouterPeerQueueLimit(maxMessages);
+}
+
 void RepRouter::connectToAddress(const QString &addr)
 {
 	d->sock->connectToAddress(addr);
@@ -93,9 +103,9 @@ ReqMessage RepRouter::read()
 	return ReqMessage(d->sock->read());
 }
 
-void RepRouter::write(const ReqMessage &message)
+bool RepRouter::write(const ReqMessage &message)
 {
-	d->sock->write(message.toRawMessage());
+	return d->sock->write(message.toRawMessage());
 }
 
 }
@@ -40,13 +40,20 @@ public:
 
 	void setShutdownWaitTime(int msecs);
 
+	// see Socket::setRouterPeerQueuesEnabled
+	void setPeerQueuesEnabled(bool enable);
+	void setPeerQueueLimit(int maxMessages);
+
 	void connectToAddress(const QString &addr);
 	bool bind(const QString &addr);
 
 	bool canRead() const;
 
 	ReqMessage read();
-	void write(const ReqMessage &message);
+
+	// returns false if the reply was dropped, for example because the
+	//   peer queue limit was reached (see Socket::write)
+	bool write(const ReqMessage &message);
 
 signals:
 	void readyRead();
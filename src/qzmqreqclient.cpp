@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqreqclient.h"
+
+#include <QPointer>
+#include <QTimer>
+#include <QHash>
+#include <QMultiMap>
+#include <QElapsedTimer>
+#include "qzmqsocket.h"
+#include "qzmqreqmessage.h"
+
+namespace QZmq {
+
+class ReqClient::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	ReqClient *q;
+	Socket *sock;
+	int timeout;
+	quint64 nextId;
+	QElapsedTimer clock;
+	QTimer *expireTimer;
+
+	// request id -> deadline, or -1 if none
+	QHash<QByteArray, qint64> pending;
+
+	// deadline -> request id
+	QMultiMap<qint64, QByteArray> deadlines;
+
+	Private(ReqClient *_q) :
+		QObject(_q),
+		q(_q),
+		timeout(-1),
+		nextId(0)
+	{
+		sock = new Socket(Socket::Dealer, this);
+		connect(sock, SIGNAL(readyRead()), SLOT(sock_readyRead()));
+
+		expireTimer = new QTimer(this);
+		connect(expireTimer, SIGNAL(timeout()), SLOT(expireTimer_timeout()));
+		expireTimer->setSingleShot(true);
+
+		clock.start();
+	}
+
+	~Private()
+	{
+		expireTimer->disconnect(this);
+		expireTimer->setParent(0);
+		expireTimer->deleteLater();
+	}
+
+	QByteArray request(const QList<QByteArray> &content, int msecs)
+	{
+		QByteArray id = QByteArray::number(nextId++);
+
+		qint64 deadline = -1;
+		if(msecs >= 0)
+		{
+			deadline = clock.elapsed() + msecs;
+			deadlines.insert(deadline, id);
+		}
+
+		pending.insert(id, deadline);
+
+		sock->write(ReqMessage(QList<QByteArray>() << id, content).toRawMessage());
+
+		if(deadline >= 0)
+			updateExpireTimer();
+
+		return id;
+	}
+
+	void remove(const QByteArray &id)
+	{
+		QHash<QByteArray, qint64>::iterator it = pending.find(id);
+		if(it == pending.end())
+			return;
+
+		qint64 deadline = it.value();
+		pending.erase(it);
+
+		if(deadline >= 0)
+		{
+			deadlines.remove(deadline, id);
+			updateExpireTimer();
+		}
+	}
+
+	void updateExpireTimer()
+	{
+		if(deadlines.isEmpty())
+		{
+			expireTimer->stop();
+			return;
+		}
+
+		qint64 wait = deadlines.firstKey() - clock.elapsed();
+		expireTimer->start((int)qMax(wait, (qint64)0));
+	}
+
+private slots:
+	void sock_readyRead()
+	{
+		QPointer<QObject> self = this;
+
+		while(sock->canRead())
+		{
+			ReqMessage msg(sock->read());
+			if(msg.isNull())
+				continue;
+
+			// our envelope has a single part, the request id
+			if(msg.headerCount() != 1)
+				continue;
+
+			QByteArray id = msg.headerAt(0);
+			if(!pending.contains(id))
+			{
+				// canceled or timed out
+				continue;
+			}
+
+			remove(id);
+
+			emit q->replyReady(id, msg.content());
+			if(!self)
+				return;
+		}
+	}
+
+	void expireTimer_timeout()
+	{
+		QPointer<QObject> self = this;
+
+		qint64 now = clock.elapsed();
+
+		QList<QByteArray> expired;
+		while(!deadlines.isEmpty() && deadlines.firstKey() <= now)
+		{
+			QByteArray id = deadlines.first();
+			deadlines.erase(deadlines.begin());
+			pending.remove(id);
+			expired += id;
+		}
+
+		updateExpireTimer();
+
+		foreach(const QByteArray &id, expired)
+		{
+			emit q->requestTimedOut(id);
+			if(!self)
+				return;
+		}
+	}
+};
+
+ReqClient::ReqClient(QObject *parent) :
+	QObject(parent)
+{
+	d = new Private(this);
+}
+
+ReqClient::~ReqClient()
+{
+	delete d;
+}
+
+void ReqClient::setShutdownWaitTime(int msecs)
+{
+	d->sock->setShutdownWaitTime(msecs);
+}
+
+void ReqClient::setTimeout(int msecs)
+{
+	d->timeout = msecs;
+}
+
+void ReqClient::connectToAddress(const QString &addr)
+{
+	d->sock->connectToAddress(addr);
+}
+
+int ReqClient::pendingCount() const
+{
+	return d->pending.count();
+}
+
+QByteArray ReqClient::request(const QList<QByteArray> &content)
+{
+	return d->request(content, d->timeout);
+}
+
+QByteArray ReqClient::request(const QList<QByteArray> &content, int timeout)
+{
+	return d->request(content, timeout);
+}
+
+void ReqClient::cancel(const QByteArray &id)
+{
+	d->remove(id);
+}
+
+}
+
+#include "qzmqreqclient.moc"
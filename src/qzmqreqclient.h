@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQREQCLIENT_H
+#define QZMQREQCLIENT_H
+
+#include <QObject>
+
+namespace QZmq {
+
+// the client side counterpart to RepRouter. unlike a REQ socket, many
+//   requests may be outstanding at once. each request is tagged with an id
+//   in its envelope, and replies are matched back to requests using it.
+//   works with RepRouter, ROUTER and REP servers
+class ReqClient : public QObject
+{
+	Q_OBJECT
+
+public:
+	ReqClient(QObject *parent = 0);
+	~ReqClient();
+
+	void setShutdownWaitTime(int msecs);
+
+	// how long to wait for a reply before giving up on a request. -1 means
+	//   forever (default = -1)
+	void setTimeout(int msecs);
+
+	void connectToAddress(const QString &addr);
+
+	int pendingCount() const;
+
+	// returns the id of the request, which is used in the signals
+	QByteArray request(const QList<QByteArray> &content);
+	QByteArray request(const QList<QByteArray> &content, int timeout);
+
+	// forget about a request. a reply to it will be ignored
+	void cancel(const QByteArray &id);
+
+signals:
+	void replyReady(const QByteArray &id, const QList<QByteArray> &content);
+	void requestTimedOut(const QByteArray &id);
+
+private:
+	Q_DISABLE_COPY(ReqClient)
+
+	class Private;
+	friend class Private;
+	Private *d;
+};
+
+}
+
+#endif
@@ -29,56 +29,99 @@ namespace QZmq {
 class ReqMessage
 {
 public:
-	ReqMessage()
+	ReqMessage() :
+		delimiter_(-1)
 	{
 	}
 
 	ReqMessage(const QList<QByteArray> &headers, const QList<QByteArray> &content) :
-		headers_(headers),
-		content_(content)
+		raw_(headers),
+		delimiter_(headers.count())
 	{
+		raw_.reserve(headers.count() + 1 + content.count());
+		raw_ += QByteArray();
+		raw_ += content;
 	}
 
-	ReqMessage(const QList<QByteArray> &rawMessage)
+	// the raw message is kept as is, and headers and content refer to the
+	//   parts before and after the first empty part
+	ReqMessage(const QList<QByteArray> &rawMessage) :
+		raw_(rawMessage),
+		delimiter_(-1)
 	{
-		bool collectHeaders = true;
-		foreach(const QByteArray &part, rawMessage)
+		for(int n = 0; n < raw_.count(); ++n)
 		{
-			if(part.isEmpty())
+			if(raw_[n].isEmpty())
 			{
-				collectHeaders = false;
-				continue;
+				delimiter_ = n;
+				break;
 			}
-
-			if(collectHeaders)
-				headers_ += part;
-			else
-				content_ += part;
 		}
 	}
 
-	bool isNull() const { return headers_.isEmpty() && content_.isEmpty(); }
+	bool isNull() const { return headerCount() == 0 && contentCount() == 0; }
+
+	int headerCount() const { return (delimiter_ != -1 ? delimiter_ : raw_.count()); }
+	const QByteArray & headerAt(int index) const { return raw_[index]; }
+
+	int contentCount() const { return (delimiter_ != -1 ? raw_.count() - delimiter_ - 1 : 0); }
+	const QByteArray & contentAt(int index) const { return raw_[delimiter_ + 1 + index]; }
+
+	// these return copies of the lists. use the accessors above to avoid
+	//   that
+	QList<QByteArray> headers() const { return raw_.mid(0, headerCount()); }
+	QList<QByteArray> content() const { return (delimiter_ != -1 ? raw_.mid(delimiter_ + 1) : QList<QByteArray>()); }
 
-	QList<QByteArray> headers() const { return headers_; }
-	QList<QByteArray> content() const { return content_; }
+	ReqMessage createReply(const QList<QByteArray> &content) const
+	{
+		int count = headerCount();
+
+		ReqMessage out;
+		out.raw_.reserve(count + 1 + content.count());
+		for(int n = 0; n < count; ++n)
+			out.raw_ += raw_[n];
+		out.raw_ += QByteArray();
+		out.raw_ += content;
+		out.delimiter_ = count;
+		return out;
+	}
 
-	ReqMessage createReply(const QList<QByteArray> &content)
+	// like createReply, but reuses this message's storage for the reply.
+	//   this message is left null
+	ReqMessage takeReply(const QList<QByteArray> &content)
 	{
-		return ReqMessage(headers_, content);
+		ReqMessage out;
+		out.raw_.swap(raw_);
+		out.delimiter_ = delimiter_;
+		delimiter_ = -1;
+
+		if(out.delimiter_ == -1)
+		{
+			out.delimiter_ = out.raw_.count();
+			out.raw_ += QByteArray();
+		}
+		else
+		{
+			out.raw_.erase(out.raw_.begin() + out.delimiter_ + 1, out.raw_.end());
+		}
+
+		out.raw_ += content;
+		return out;
 	}
 
 	QList<QByteArray> toRawMessage() const
 	{
-		QList<QByteArray> out;
-		out += headers_;
+		if(delimiter_ != -1)
+			return raw_;
+
+		QList<QByteArray> out = raw_;
 		out += QByteArray();
-		out += content_;
 		return out;
 	}
 
 private:
-	QList<QByteArray> headers_;
-	QList<QByteArray> content_;
+	QList<QByteArray> raw_;
+	int delimiter_;
 };
 
 }
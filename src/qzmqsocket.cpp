@@ -30,8 +30,16 @@
 #include <QTimer>
 #include <QSocketNotifier>
 #include <QMutex>
+#include <QVector>
+#include <QHash>
+#include <QThread>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QElapsedTimer>
+#include <QThreadStorage>
 #include <zmq.h>
 #include "qzmqcontext.h"
+#include "qzmqcapture.h"
 
 namespace QZmq {
 
@@ -104,6 +112,52 @@ static void set_immediate(void *sock, bool on)
 
 #endif
 
+static quint64 get_affinity(void *sock)
+{
+	quint64 v;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_getsockopt(sock, ZMQ_AFFINITY, &v, &opt_len);
+	assert(ret == 0);
+	return v;
+}
+
+static void set_affinity(void *sock, quint64 value)
+{
+	quint64 v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_AFFINITY, &v, opt_len);
+	assert(ret == 0);
+}
+
+static void set_backlog(void *sock, int value)
+{
+	int v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_BACKLOG, &v, opt_len);
+	assert(ret == 0);
+}
+
+#ifdef ZMQ_TOS
+
+static void set_tos(void *sock, int value)
+{
+	int v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_TOS, &v, opt_len);
+	assert(ret == 0);
+}
+
+#else
+
+static void set_tos(void *sock, int value)
+{
+	// not supported for this zmq version
+	Q_UNUSED(sock);
+	Q_UNUSED(value);
+}
+
+#endif
+
 #if (ZMQ_VERSION_MAJOR >= 4) || ((ZMQ_VERSION_MAJOR >= 3) && (ZMQ_VERSION_MINOR >= 2))
 
 #define USE_MSG_IO
@@ -211,6 +265,56 @@ static void set_tcp_keepalive_intvl(void *sock, int value)
 	assert(ret == 0);
 }
 
+static void set_router_mandatory(void *sock, bool on)
+{
+	int v = on ? 1 : 0;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_ROUTER_MANDATORY, &v, opt_len);
+	assert(ret == 0);
+}
+
+static int get_sndbuf(void *sock)
+{
+	int v;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_getsockopt(sock, ZMQ_SNDBUF, &v, &opt_len);
+	assert(ret == 0);
+	return v;
+}
+
+static void set_sndbuf(void *sock, int value)
+{
+	int v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_SNDBUF, &v, opt_len);
+	assert(ret == 0);
+}
+
+static int get_rcvbuf(void *sock)
+{
+	int v;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_getsockopt(sock, ZMQ_RCVBUF, &v, &opt_len);
+	assert(ret == 0);
+	return v;
+}
+
+static void set_rcvbuf(void *sock, int value)
+{
+	int v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_RCVBUF, &v, opt_len);
+	assert(ret == 0);
+}
+
+static void set_maxmsgsize(void *sock, qint64 value)
+{
+	qint64 v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_MAXMSGSIZE, &v, opt_len);
+	assert(ret == 0);
+}
+
 #else
 
 static bool get_rcvmore(void *sock)
@@ -304,207 +408,1321 @@ static void set_tcp_keepalive_intvl(void *sock, int value)
 	Q_UNUSED(on);
 }
 
+static void set_router_mandatory(void *sock, bool on)
+{
+	// not supported for this zmq version
+	Q_UNUSED(sock);
+	Q_UNUSED(on);
+}
+
+static int get_sndbuf(void *sock)
+{
+	quint64 v;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_getsockopt(sock, ZMQ_SNDBUF, &v, &opt_len);
+	assert(ret == 0);
+	return (int)v;
+}
+
+static void set_sndbuf(void *sock, int value)
+{
+	quint64 v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_SNDBUF, &v, opt_len);
+	assert(ret == 0);
+}
+
+static int get_rcvbuf(void *sock)
+{
+	quint64 v;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_getsockopt(sock, ZMQ_RCVBUF, &v, &opt_len);
+	assert(ret == 0);
+	return (int)v;
+}
+
+static void set_rcvbuf(void *sock, int value)
+{
+	quint64 v = value;
+	size_t opt_len = sizeof(v);
+	int ret = zmq_setsockopt(sock, ZMQ_RCVBUF, &v, opt_len);
+	assert(ret == 0);
+}
+
+static void set_maxmsgsize(void *sock, qint64 value)
+{
+	// not supported for this zmq version
+	Q_UNUSED(sock);
+	Q_UNUSED(value);
+}
+
 #endif
 
-Q_GLOBAL_STATIC(QMutex, g_mutex)
+// called by zmq once it is done with a frame's data, possibly from one of
+//   its i/o threads. QByteArray reference counting is atomic, so dropping
+//   the reference from there is safe
+static void release_pinned_data(void *data, void *hint)
+{
+	Q_UNUSED(data);
+
+	delete (QByteArray *)hint;
+}
+
+// initializes msg with the content of buf. if buf is at least
+//   zeroCopyThreshold bytes, the data is referenced rather than copied
+static void init_msg(zmq_msg_t *msg, const QByteArray &buf, int zeroCopyThreshold)
+{
+	int ret;
+	if(zeroCopyThreshold >= 0 && !buf.isEmpty() && buf.size() >= zeroCopyThreshold)
+	{
+		// hold a reference to the data until zmq releases it
+		QByteArray *pinned = new QByteArray(buf);
+
+		ret = zmq_msg_init_data(msg, (void *)pinned->constData(), pinned->size(), release_pinned_data, pinned);
+		assert(ret == 0);
+	}
+	else
+	{
+		ret = zmq_msg_init_size(msg, buf.size());
+		assert(ret == 0);
+
+		memcpy(zmq_msg_data(msg), buf.data(), buf.size());
+	}
+}
 
 class Global
 {
 public:
 	Context context;
-	int refs;
+	QAtomicInt refs;
 
-	Global() :
-		refs(0)
+	// a shared global is created and destroyed under g_mutex, so that a
+	//   new reference can't be taken while the last one is being dropped.
+	//   keep-alive and per-thread globals are refcounted without locking
+	bool shared;
+
+	Global(bool _shared) :
+		context(Context::globalOptions()),
+		refs(0),
+		shared(_shared)
+	{
+	}
+};
+
+// holds a reference to a per-thread global on behalf of the thread, so
+//   that the context outlives sockets created in the thread but moved
+//   elsewhere, and is released when the thread ends
+class ThreadGlobal
+{
+public:
+	Global *global;
+
+	ThreadGlobal() :
+		global(new Global(false))
 	{
+		global->refs.ref();
+	}
+
+	~ThreadGlobal()
+	{
+		if(!global->refs.deref())
+			delete global;
 	}
 };
 
+Q_GLOBAL_STATIC(QMutex, g_mutex)
+Q_GLOBAL_STATIC(QThreadStorage<ThreadGlobal*>, g_threadGlobals)
+
 static Global *global = 0;
+static QAtomicPointer<Global> keepAliveGlobal;
 
-static Context *addGlobalContextRef()
+class GlobalStats
 {
-	QMutexLocker locker(g_mutex());
-
-	if(!global)
-		global = new Global;
+public:
+	QMutex mutex;
+	QAtomicInt enabled;
+	SocketStats stats;
+};
 
-	++(global->refs);
-	return &(global->context);
-}
+Q_GLOBAL_STATIC(GlobalStats, g_stats)
 
-static void removeGlobalContextRef()
+static Global *addGlobalContextRef()
 {
-	QMutexLocker locker(g_mutex());
+	Context::GlobalPolicy policy = Context::globalPolicy();
+
+	if(policy == Context::KeepAlive)
+	{
+		Global *g = keepAliveGlobal.loadAcquire();
+		if(!g)
+		{
+			QMutexLocker locker(g_mutex());
+
+			g = keepAliveGlobal.loadAcquire();
+			if(!g)
+			{
+				g = new Global(false);
+
+				// never released
+				g->refs.ref();
+
+				keepAliveGlobal.storeRelease(g);
+			}
+		}
 
-	assert(global);
-	assert(global->refs > 0);
+		g->refs.ref();
+		return g;
+	}
+	else if(policy == Context::PerThread)
+	{
+		QThreadStorage<ThreadGlobal*> *storage = g_threadGlobals();
+		if(!storage->hasLocalData())
+			storage->setLocalData(new ThreadGlobal);
 
-	--(global->refs);
-	if(global->refs == 0)
+		Global *g = storage->localData()->global;
+		g->refs.ref();
+		return g;
+	}
+	else // ReleaseWhenUnused
 	{
-		delete global;
-		global = 0;
+		QMutexLocker locker(g_mutex());
+
+		if(!global)
+			global = new Global(true);
+
+		global->refs.ref();
+		return global;
 	}
 }
 
-class Socket::Private : public QObject
+static void removeGlobalContextRef(Global *g)
 {
-	Q_OBJECT
+	if(g->shared)
+	{
+		QMutexLocker locker(g_mutex());
 
-public:
-	Socket *q;
-	bool usingGlobalContext;
-	Context *context;
-	void *sock;
-	QSocketNotifier *sn_read;
-	bool canWrite, canRead;
-	QList< QList<QByteArray> > pendingWrites;
-	int pendingWritten;
-	QTimer *updateTimer;
-	bool pendingUpdate;
-	int shutdownWaitTime;
-	bool writeQueueEnabled;
+		assert(g == global);
 
-	Private(Socket *_q, Socket::Type type, Context *_context) :
-		QObject(_q),
-		q(_q),
-		canWrite(false),
-		canRead(false),
-		pendingWritten(0),
-		pendingUpdate(false),
-		shutdownWaitTime(-1),
-		writeQueueEnabled(true)
-	{
-		if(_context)
-		{
-			usingGlobalContext = false;
-			context = _context;
-		}
-		else
+		if(!g->refs.deref())
 		{
-			usingGlobalContext = true;
-			context = addGlobalContextRef();
+			delete global;
+			global = 0;
 		}
+	}
+	else
+	{
+		if(!g->refs.deref())
+			delete g;
+	}
+}
 
-		int ztype = 0;
-		switch(type)
-		{
-			case Socket::Pair: ztype = ZMQ_PAIR; break;
-			case Socket::Dealer: ztype = ZMQ_DEALER; break;
-			case Socket::Router: ztype = ZMQ_ROUTER; break;
-			case Socket::Req: ztype = ZMQ_REQ; break;
-			case Socket::Rep: ztype = ZMQ_REP; break;
-			case Socket::Push: ztype = ZMQ_PUSH; break;
-			case Socket::Pull: ztype = ZMQ_PULL; break;
-			case Socket::Pub: ztype = ZMQ_PUB; break;
-			case Socket::Sub: ztype = ZMQ_SUB; break;
-			default:
-				assert(0);
-		}
+// takes another reference to a global that the caller already holds one to
+static void refGlobalContext(Global *g)
+{
+	if(g->shared)
+	{
+		QMutexLocker locker(g_mutex());
+		g->refs.ref();
+	}
+	else
+		g->refs.ref();
+}
 
-		sock = zmq_socket(context->context(), ztype);
-		assert(sock != NULL);
+// fifo of messages waiting to be written. it is backed by a ring buffer
+//   that grows as needed, so removing from the front never moves the other
+//   entries. the total size of the queued data is tracked as well
+class WriteQueue
+{
+public:
+	WriteQueue() :
+		start_(0),
+		count_(0),
+		bytes_(0)
+	{
+	}
 
-		sn_read = new QSocketNotifier(get_fd(sock), QSocketNotifier::Read, this);
-		connect(sn_read, SIGNAL(activated(int)), SLOT(sn_read_activated()));
-		sn_read->setEnabled(true);
+	bool isEmpty() const { return (count_ == 0); }
+	int count() const { return count_; }
+	qint64 bytes() const { return bytes_; }
 
-		updateTimer = new QTimer(this);
-		connect(updateTimer, SIGNAL(timeout()), SLOT(update_timeout()));
-		updateTimer->setSingleShot(true);
+	const QList<QByteArray> & first() const
+	{
+		assert(count_ > 0);
+		return items_[start_];
 	}
 
-	~Private()
+	// when the first message was queued, or -1 if not known
+	qint64 firstTime() const
 	{
-		updateTimer->disconnect(this);
-		updateTimer->setParent(0);
-		updateTimer->deleteLater();
-
-		set_linger(sock, shutdownWaitTime);
-		zmq_close(sock);
-
-		if(usingGlobalContext)
-			removeGlobalContextRef();
+		assert(count_ > 0);
+		return times_[start_];
 	}
 
-	void update()
+	void reserve(int size)
 	{
-		if(!pendingUpdate)
+		if(size <= items_.size())
+			return;
+
+		// capacity is kept at a power of two so positions can be masked
+		int capacity = qMax(items_.size(), 8);
+		while(capacity < size)
+			capacity *= 2;
+
+		QVector< QList<QByteArray> > newItems(capacity);
+		QVector<qint64> newTimes(capacity);
+		for(int n = 0; n < count_; ++n)
 		{
-			pendingUpdate = true;
-			updateTimer->start();
+			int at = (start_ + n) & (items_.size() - 1);
+			newItems[n] = items_[at];
+			newTimes[n] = times_[at];
 		}
+
+		items_ = newItems;
+		times_ = newTimes;
+		start_ = 0;
 	}
 
-	QList<QByteArray> read()
+	void append(const QList<QByteArray> &message, qint64 time = -1)
 	{
-		if(canRead)
-		{
-			QList<QByteArray> out;
-
-			bool ok = true;
+		if(count_ == items_.size())
+			reserve(count_ + 1);
+
+		int at = (start_ + count_) & (items_.size() - 1);
+		items_[at] = message;
+		times_[at] = time;
+		++count_;
+		bytes_ += messageSize(message);
+	}
 
-			do
-			{
-				zmq_msg_t msg;
+	void removeFirst()
+	{
+		assert(count_ > 0);
 
-				int ret = zmq_msg_init(&msg);
-				assert(ret == 0);
+		bytes_ -= messageSize(items_[start_]);
 
-#ifdef USE_MSG_IO
-				ret = zmq_msg_recv(&msg, sock, ZMQ_DONTWAIT);
-#else
-				ret = zmq_recv(sock, &msg, ZMQ_NOBLOCK);
-#endif
+		// release the data now rather than when the slot is reused
+		items_[start_] = QList<QByteArray>();
 
-				if(ret < 0)
-				{
-					ret = zmq_msg_close(&msg);
-					assert(ret == 0);
+		start_ = (start_ + 1) & (items_.size() - 1);
+		--count_;
+	}
 
-					ok = false;
-					break;
-				}
+	void clear()
+	{
+		items_.clear();
+		times_.clear();
+		start_ = 0;
+		count_ = 0;
+		bytes_ = 0;
+	}
 
-				QByteArray buf((const char *)zmq_msg_data(&msg), zmq_msg_size(&msg));
+private:
+	QVector< QList<QByteArray> > items_;
+	QVector<qint64> times_;
+	int start_;
+	int count_;
+	qint64 bytes_;
 
-				ret = zmq_msg_close(&msg);
-				assert(ret == 0);
+	static qint64 messageSize(const QList<QByteArray> &message)
+	{
+		qint64 size = 0;
+		foreach(const QByteArray &buf, message)
+			size += buf.size();
+		return size;
+	}
+};
 
-				out += buf;
-			} while(get_rcvmore(sock));
+// messages waiting to be written to a router socket, kept in a separate
+//   fifo per peer. the peer is identified by the first frame of each
+//   message. peers with queued messages are visited in round-robin order
+class PeerWriteQueue
+{
+public:
+	PeerWriteQueue() :
+		count_(0),
+		bytes_(0)
+	{
+	}
 
-			processEvents();
+	bool isEmpty() const { return (count_ == 0); }
+	int count() const { return count_; }
+	qint64 bytes() const { return bytes_; }
+	int peerCount() const { return order_.count(); }
 
-			if((canWrite && !pendingWrites.isEmpty()) || canRead)
-				update();
+	int peerQueueCount(const QByteArray &id) const
+	{
+		QHash<QByteArray, WriteQueue>::const_iterator it = queues_.constFind(id);
+		if(it == queues_.constEnd())
+			return 0;
 
-			if(ok)
-				return out;
-			else
-				return QList<QByteArray>();
-		}
-		else
-			return QList<QByteArray>();
+		return it.value().count();
 	}
 
-	void write(const QList<QByteArray> &message)
+	void append(const QList<QByteArray> &message, qint64 time = -1)
 	{
-		assert(!message.isEmpty());
+		const QByteArray &id = message.first();
+
+		WriteQueue &q = queues_[id];
+		if(q.isEmpty())
+			order_ += id;
+
+		qint64 size = q.bytes();
+		q.append(message, time);
+
+		++count_;
+		bytes_ += q.bytes() - size;
+	}
+
+	// the first message of the peer whose turn it is
+	const QList<QByteArray> & current() const
+	{
+		assert(!order_.isEmpty());
+		return queues_.constFind(order_.first()).value().first();
+	}
+
+	qint64 currentTime() const
+	{
+		assert(!order_.isEmpty());
+		return queues_.constFind(order_.first()).value().firstTime();
+	}
+
+	// remove the current message, and pass the turn to the next peer
+	void removeCurrent()
+	{
+		assert(!order_.isEmpty());
+
+		QByteArray id = order_.takeFirst();
+		WriteQueue &q = queues_[id];
+
+		qint64 size = q.bytes();
+		q.removeFirst();
+
+		--count_;
+		bytes_ -= size - q.bytes();
+
+		if(q.isEmpty())
+			queues_.remove(id);
+		else
+			order_ += id;
+	}
+
+	// drop all messages of the current peer
+	void removeCurrentPeer()
+	{
+		assert(!order_.isEmpty());
+
+		QByteArray id = order_.takeFirst();
+		const WriteQueue &q = queues_[id];
+
+		count_ -= q.count();
+		bytes_ -= q.bytes();
+
+		queues_.remove(id);
+	}
+
+	// pass the turn to the next peer without removing anything
+	void skipCurrent()
+	{
+		assert(!order_.isEmpty());
+
+		order_ += order_.takeFirst();
+	}
+
+private:
+	QHash<QByteArray, WriteQueue> queues_;
+	QList<QByteArray> order_;
+	int count_;
+	qint64 bytes_;
+};
+
+// bounded queue for passing items from one thread to another without
+//   locking. only one thread may push and only one thread may pop
+template <typename T>
+class SpscQueue
+{
+public:
+	SpscQueue(int capacity) :
+		size_(1),
+		head_(0),
+		tail_(0)
+	{
+		// size is kept at a power of two so positions can be masked
+		while(size_ < capacity)
+			size_ *= 2;
+
+		items_ = new T[size_];
+	}
+
+	~SpscQueue()
+	{
+		delete [] items_;
+	}
+
+	bool isEmpty() const
+	{
+		return (head_.loadAcquire() == tail_.loadAcquire());
+	}
+
+	bool isFull() const
+	{
+		return ((uint)tail_.loadAcquire() - (uint)head_.loadAcquire() >= (uint)size_);
+	}
+
+	// producer side
+	bool push(const T &item)
+	{
+		uint tail = (uint)tail_.loadAcquire();
+		if(tail - (uint)head_.loadAcquire() >= (uint)size_)
+			return false;
+
+		items_[tail & (size_ - 1)] = item;
+		tail_.storeRelease((int)(tail + 1));
+		return true;
+	}
+
+	// consumer side. the queue must not be empty
+	T & front()
+	{
+		return items_[(uint)head_.loadAcquire() & (size_ - 1)];
+	}
+
+	void pop()
+	{
+		uint head = (uint)head_.loadAcquire();
+
+		// release the item now rather than when the slot is reused
+		items_[head & (size_ - 1)] = T();
+
+		head_.storeRelease((int)(head + 1));
+	}
+
+private:
+	Q_DISABLE_COPY(SpscQueue)
+
+	T *items_;
+	int size_;
+	QAtomicInt head_;
+	QAtomicInt tail_;
+};
+
+// performs the socket i/o on a separate thread. it takes over the zmq
+//   socket and exchanges messages with the owning thread through a pair
+//   of lock-free queues. the owning thread is notified by invoking a
+//   method on the target object, at most once until the target calls
+//   clearNotify
+class IoThread : public QThread
+{
+public:
+	SpscQueue< QList<Frame> > incoming;
+	SpscQueue< QList<QByteArray> > outgoing;
+
+	IoThread(void *context, void *sock, QObject *target, const char *method, int queueSize, int zeroCopyWriteThreshold) :
+		incoming(queueSize),
+		outgoing(queueSize),
+		sock_(sock),
+		target_(target),
+		method_(method),
+		zeroCopyWriteThreshold_(zeroCopyWriteThreshold),
+		outPos_(0)
+	{
+		QByteArray addr = "inproc://qzmq-iothread-" + QByteArray::number((quint64)this, 16);
+
+		wakeIn_ = zmq_socket(context, ZMQ_PAIR);
+		assert(wakeIn_ != NULL);
+		int ret = zmq_bind(wakeIn_, addr.data());
+		assert(ret == 0);
+
+		wakeOut_ = zmq_socket(context, ZMQ_PAIR);
+		assert(wakeOut_ != NULL);
+		ret = zmq_connect(wakeOut_, addr.data());
+		assert(ret == 0);
+	}
+
+	~IoThread()
+	{
+		stopping_.storeRelease(1);
+		wake();
+		wait();
+
+		set_linger(wakeOut_, 0);
+		zmq_close(wakeOut_);
+		set_linger(wakeIn_, 0);
+		zmq_close(wakeIn_);
+	}
+
+	// called from the owning thread after pushing to outgoing
+	void wake()
+	{
+		if(!wakePending_.testAndSetOrdered(0, 1))
+			return;
+
+		zmq_msg_t msg;
+		int ret = zmq_msg_init(&msg);
+		assert(ret == 0);
+
+#ifdef USE_MSG_IO
+		zmq_msg_send(&msg, wakeOut_, ZMQ_DONTWAIT);
+#else
+		zmq_send(wakeOut_, &msg, ZMQ_NOBLOCK);
+#endif
+
+		ret = zmq_msg_close(&msg);
+		assert(ret == 0);
+	}
+
+	// called from the owning thread after popping from incoming
+	void readFinished()
+	{
+		if(readStalled_.testAndSetOrdered(1, 0))
+			wake();
+	}
+
+	// called from the owning thread before looking at the queues
+	void clearNotify()
+	{
+		notifyPending_.storeRelease(0);
+	}
+
+protected:
+	virtual void run()
+	{
+		while(!stopping_.loadAcquire())
+		{
+			drainWake();
+
+			bool activity = false;
+			bool writeBlocked = false;
+			bool readBlocked = false;
+
+			while(!outgoing.isEmpty())
+			{
+				if(!writeOutgoing())
+				{
+					writeBlocked = true;
+					break;
+				}
+
+				activity = true;
+			}
+
+			while(true)
+			{
+				if(incoming.isFull())
+				{
+					// tell the owner to wake us once there is room. check
+					//   again afterwards, in case it made room in between
+					readStalled_.storeRelease(1);
+					if(incoming.isFull())
+					{
+						readBlocked = true;
+						break;
+					}
+
+					readStalled_.storeRelease(0);
+				}
+
+				QList<Frame> message;
+				if(!readMessage(&message))
+					break;
+
+				incoming.push(message);
+				activity = true;
+			}
+
+			if(activity && notifyPending_.testAndSetOrdered(0, 1))
+				QMetaObject::invokeMethod(target_, method_, Qt::QueuedConnection);
+
+			zmq_pollitem_t items[2];
+			items[0].socket = sock_;
+			items[0].fd = 0;
+			items[0].events = (readBlocked ? 0 : ZMQ_POLLIN) | (writeBlocked ? ZMQ_POLLOUT : 0);
+			items[0].revents = 0;
+			items[1].socket = wakeIn_;
+			items[1].fd = 0;
+			items[1].events = ZMQ_POLLIN;
+			items[1].revents = 0;
+
+			if(!wakePending_.loadAcquire() && !stopping_.loadAcquire())
+				zmq_poll(items, 2, -1);
+		}
+
+		// one last try to hand over anything still queued, so it is
+		//   subject to the linger time like everything else
+		while(!outgoing.isEmpty() && writeOutgoing()) {}
+	}
+
+private:
+	void *sock_;
+	void *wakeIn_;
+	void *wakeOut_;
+	QObject *target_;
+	const char *method_;
+	int zeroCopyWriteThreshold_;
+	int outPos_;
+	QAtomicInt stopping_;
+	QAtomicInt wakePending_;
+	QAtomicInt readStalled_;
+	QAtomicInt notifyPending_;
+
+	void drainWake()
+	{
+		// clear the flag first, so that a wake that comes in while we
+		//   are working isn't lost
+		wakePending_.storeRelease(0);
+
+		while(true)
+		{
+			zmq_msg_t msg;
+			int ret = zmq_msg_init(&msg);
+			assert(ret == 0);
+
+#ifdef USE_MSG_IO
+			ret = zmq_msg_recv(&msg, wakeIn_, ZMQ_DONTWAIT);
+#else
+			ret = zmq_recv(wakeIn_, &msg, ZMQ_NOBLOCK);
+#endif
+
+			zmq_msg_close(&msg);
+
+			if(ret < 0)
+				break;
+		}
+	}
+
+	// writes the rest of the first outgoing message, resuming at the
+	//   part where a previous attempt stopped. returns false if zmq
+	//   can't take more right now
+	bool writeOutgoing()
+	{
+		const QList<QByteArray> &message = outgoing.front();
+
+		for(; outPos_ < message.count(); ++outPos_)
+		{
+			zmq_msg_t msg;
+			init_msg(&msg, message[outPos_], zeroCopyWriteThreshold_);
+
+			int flags = (outPos_ + 1 < message.count() ? ZMQ_SNDMORE : 0);
+#ifdef USE_MSG_IO
+			int ret = zmq_msg_send(&msg, sock_, ZMQ_DONTWAIT | flags);
+#else
+			int ret = zmq_send(sock_, &msg, ZMQ_NOBLOCK | flags);
+#endif
+
+			int e = errno;
+			zmq_msg_close(&msg);
+
+			if(ret < 0)
+			{
+				if(e == EAGAIN || e == EINTR)
+					return false;
+
+				// can't be written. drop the rest
+				break;
+			}
+		}
+
+		outgoing.pop();
+		outPos_ = 0;
+		return true;
+	}
+
+	bool readMessage(QList<Frame> *out)
+	{
+		do
+		{
+			zmq_msg_t msg;
+			int ret = zmq_msg_init(&msg);
+			assert(ret == 0);
+
+#ifdef USE_MSG_IO
+			ret = zmq_msg_recv(&msg, sock_, ZMQ_DONTWAIT);
+#else
+			ret = zmq_recv(sock_, &msg, ZMQ_NOBLOCK);
+#endif
+
+			bool ok = (ret >= 0);
+			if(ok)
+				*out += Frame::fromMessage(&msg);
+
+			zmq_msg_close(&msg);
+
+			if(!ok)
+			{
+				out->clear();
+				return false;
+			}
+		} while(get_rcvmore(sock_));
+
+		return true;
+	}
+};
+
+class Socket::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	Socket *q;
+	Socket::Type type;
+	Global *global;
+	Context *context;
+	void *sock;
+	QSocketNotifier *sn_read;
+	IoThread *ioThread;
+	bool canWrite, canRead;
+	WriteQueue pendingWrites;
+	PeerWriteQueue peerWrites;
+	QList<QByteArray> inFlight;
+	int inFlightPos;
+	qint64 inFlightTime;
+	int pendingWritten;
+	QTimer *updateTimer;
+	bool pendingUpdate;
+	int shutdownWaitTime;
+	bool writeQueueEnabled;
+	int zeroCopyWriteThreshold;
+	int maxWritesPerEvent;
+	int maxQueuedMessages;
+	qint64 maxQueuedBytes;
+	bool writeQueueIsHigh;
+	bool pendingWriteQueueHigh;
+	bool peerQueuesEnabled;
+	int maxQueuedPerPeer;
+	bool peersBlocked;
+	SocketStats stats;
+	SocketStats reportedStats;
+	bool trackWriteLatency;
+	QElapsedTimer latencyClock;
+	LatencyHistogram writeLatency;
+	Capture *capture;
+
+	Private(Socket *_q, Socket::Type _type, Context *_context) :
+		QObject(_q),
+		q(_q),
+		type(_type),
+		ioThread(0),
+		canWrite(false),
+		canRead(false),
+		inFlightPos(0),
+		inFlightTime(-1),
+		pendingWritten(0),
+		pendingUpdate(false),
+		shutdownWaitTime(-1),
+		writeQueueEnabled(true),
+		zeroCopyWriteThreshold(-1),
+		maxWritesPerEvent(-1),
+		maxQueuedMessages(-1),
+		maxQueuedBytes(-1),
+		writeQueueIsHigh(false),
+		pendingWriteQueueHigh(false),
+		peerQueuesEnabled(false),
+		maxQueuedPerPeer(-1),
+		peersBlocked(false),
+		trackWriteLatency(false),
+		capture(0)
+	{
+		if(_context)
+		{
+			global = 0;
+			context = _context;
+		}
+		else
+		{
+			global = addGlobalContextRef();
+			context = &(global->context);
+		}
+
+		int ztype = 0;
+		switch(type)
+		{
+			case Socket::Pair: ztype = ZMQ_PAIR; break;
+			case Socket::Dealer: ztype = ZMQ_DEALER; break;
+			case Socket::Router: ztype = ZMQ_ROUTER; break;
+			case Socket::Req: ztype = ZMQ_REQ; break;
+			case Socket::Rep: ztype = ZMQ_REP; break;
+			case Socket::Push: ztype = ZMQ_PUSH; break;
+			case Socket::Pull: ztype = ZMQ_PULL; break;
+			case Socket::Pub: ztype = ZMQ_PUB; break;
+			case Socket::Sub: ztype = ZMQ_SUB; break;
+			default:
+				assert(0);
+		}
+
+		sock = zmq_socket(context->context(), ztype);
+		assert(sock != NULL);
+
+		sn_read = new QSocketNotifier(get_fd(sock), QSocketNotifier::Read, this);
+		connect(sn_read, SIGNAL(activated(int)), SLOT(sn_read_activated()));
+		sn_read->setEnabled(true);
+
+		updateTimer = new QTimer(this);
+		connect(updateTimer, SIGNAL(timeout()), SLOT(update_timeout()));
+		updateTimer->setSingleShot(true);
+	}
+
+	~Private()
+	{
+		updateTimer->disconnect(this);
+		updateTimer->setParent(0);
+		updateTimer->deleteLater();
+
+		// stop the thread before we touch the socket again
+		delete ioThread;
+
+		// whatever is still queued goes away with us
+		reportStats(true);
+
+		set_linger(sock, shutdownWaitTime);
+		zmq_close(sock);
+
+		if(global)
+			removeGlobalContextRef(global);
+	}
+
+	void update()
+	{
+		if(!pendingUpdate)
+		{
+			pendingUpdate = true;
+			updateTimer->start();
+		}
+	}
+
+	template <typename T>
+	static qint64 messageBytes(const QList<T> &message)
+	{
+		qint64 size = 0;
+		foreach(const T &part, message)
+			size += part.size();
+		return size;
+	}
+
+	template <typename T>
+	void recordRead(const QList<T> &message)
+	{
+		++stats.messagesRead;
+		stats.framesRead += message.count();
+		stats.bytesRead += messageBytes(message);
+
+		if(capture)
+			capture->record(Capture::Read, message);
+	}
+
+	template <typename T>
+	void recordWritten(const QList<T> &message)
+	{
+		++pendingWritten;
+
+		++stats.messagesWritten;
+		stats.framesWritten += message.count();
+		stats.bytesWritten += messageBytes(message);
+
+		if(capture)
+			capture->record(Capture::Written, message);
+	}
+
+	void recordWriteLatency(qint64 queuedAt)
+	{
+		if(trackWriteLatency && queuedAt >= 0)
+			writeLatency.record(latencyClock.nsecsElapsed() - queuedAt);
+	}
+
+	SocketStats currentStats() const
+	{
+		SocketStats out = stats;
+		out.writeQueueDepth = queuedCount();
+		out.writeQueueBytes = queuedBytes();
+		return out;
+	}
+
+	// adds what changed since the last report to the process-wide totals
+	void reportStats(bool final = false)
+	{
+		GlobalStats *g = g_stats();
+		if(!g || !g->enabled.loadAcquire())
+			return;
+
+		SocketStats cur = currentStats();
+		if(final)
+		{
+			cur.writeQueueDepth = 0;
+			cur.writeQueueBytes = 0;
+		}
+
+		SocketStats delta = cur;
+		delta -= reportedStats;
+		reportedStats = cur;
+
+		QMutexLocker locker(&g->mutex);
+		g->stats += delta;
+	}
+
+	// receives one message part into msg, which must be initialized
+	bool zmqRead(zmq_msg_t *msg)
+	{
+#ifdef USE_MSG_IO
+		int ret = zmq_msg_recv(msg, sock, ZMQ_DONTWAIT);
+#else
+		int ret = zmq_recv(sock, msg, ZMQ_NOBLOCK);
+#endif
+
+		return (ret >= 0);
+	}
+
+	void readFinished()
+	{
+		processEvents();
+
+		if((canWrite && writePending()) || canRead)
+			update();
+	}
+
+	// reads all parts of one message. returns false if nothing was read
+	bool zmqReadMessage(QList<QByteArray> *out)
+	{
+		if(ioThread)
+		{
+			QList<Frame> frames;
+			if(!zmqReadMessage(&frames))
+				return false;
+
+			foreach(const Frame &f, frames)
+				*out += f.toByteArray();
+
+			return true;
+		}
+
+		do
+		{
+			zmq_msg_t msg;
+
+			int ret = zmq_msg_init(&msg);
+			assert(ret == 0);
+
+			if(!zmqRead(&msg))
+			{
+				ret = zmq_msg_close(&msg);
+				assert(ret == 0);
+
+				out->clear();
+				return false;
+			}
+
+			QByteArray buf((const char *)zmq_msg_data(&msg), zmq_msg_size(&msg));
+
+			ret = zmq_msg_close(&msg);
+			assert(ret == 0);
+
+			*out += buf;
+		} while(get_rcvmore(sock));
+
+		recordRead(*out);
+		return true;
+	}
+
+	bool zmqReadMessage(QList<Frame> *out)
+	{
+		if(ioThread)
+		{
+			if(ioThread->incoming.isEmpty())
+				return false;
+
+			*out = ioThread->incoming.front();
+			ioThread->incoming.pop();
+			ioThread->readFinished();
+			recordRead(*out);
+			return true;
+		}
+
+		do
+		{
+			zmq_msg_t msg;
+
+			int ret = zmq_msg_init(&msg);
+			assert(ret == 0);
+
+			bool ok = zmqRead(&msg);
+			if(ok)
+				*out += Frame::fromMessage(&msg);
+
+			ret = zmq_msg_close(&msg);
+			assert(ret == 0);
+
+			if(!ok)
+			{
+				out->clear();
+				return false;
+			}
+		} while(get_rcvmore(sock));
+
+		recordRead(*out);
+		return true;
+	}
+
+	QList<QByteArray> read()
+	{
+		QList<QByteArray> out;
+
+		if(canRead)
+		{
+			zmqReadMessage(&out);
+			readFinished();
+		}
+
+		return out;
+	}
+
+	QList<Frame> readFrames()
+	{
+		QList<Frame> out;
+
+		if(canRead)
+		{
+			zmqReadMessage(&out);
+			readFinished();
+		}
+
+		return out;
+	}
+
+	QList< QList<QByteArray> > readBatch(int maxMessages, int maxBytes)
+	{
+		QList< QList<QByteArray> > out;
+
+		if(canRead)
+		{
+			// keep receiving until zmq has nothing more for us. the events
+			//   are only checked once, at the end
+			int bytes = 0;
+			while((maxMessages < 0 || out.count() < maxMessages) && (maxBytes < 0 || bytes < maxBytes))
+			{
+				QList<QByteArray> message;
+				if(!zmqReadMessage(&message))
+					break;
+
+				foreach(const QByteArray &buf, message)
+					bytes += buf.size();
+
+				out += message;
+			}
+
+			readFinished();
+		}
+
+		return out;
+	}
+
+	int queuedCount() const
+	{
+		return pendingWrites.count() + peerWrites.count();
+	}
+
+	qint64 queuedBytes() const
+	{
+		return pendingWrites.bytes() + peerWrites.bytes();
+	}
+
+	// return true if there are messages we could try writing
+	bool writePending() const
+	{
+		return (!inFlight.isEmpty() || !pendingWrites.isEmpty() || (!peerWrites.isEmpty() && !peersBlocked));
+	}
+
+	bool writeQueueFull() const
+	{
+		return ((maxQueuedMessages >= 0 && queuedCount() >= maxQueuedMessages) ||
+			(maxQueuedBytes >= 0 && queuedBytes() >= maxQueuedBytes));
+	}
+
+	bool writeQueueDrained() const
+	{
+		return ((maxQueuedMessages < 0 || queuedCount() <= maxQueuedMessages / 2) &&
+			(maxQueuedBytes < 0 || queuedBytes() <= maxQueuedBytes / 2));
+	}
+
+	// return false if the message was refused
+	bool enqueue(const QList<QByteArray> &message)
+	{
+		qint64 time = (trackWriteLatency ? latencyClock.nsecsElapsed() : -1);
+
+		if(peerQueuesEnabled)
+		{
+			if(maxQueuedPerPeer >= 0 && peerWrites.peerQueueCount(message.first()) >= maxQueuedPerPeer)
+				return false;
+
+			peerWrites.append(message, time);
+
+			// give blocked peers another chance
+			peersBlocked = false;
+		}
+		else
+			pendingWrites.append(message, time);
+
+		int depth = queuedCount();
+		if(depth > stats.writeQueueHighWatermark)
+			stats.writeQueueHighWatermark = depth;
+
+		return true;
+	}
+
+	// writeQueueHigh is emitted later from doUpdate, so that writing
+	//   never emits
+	void checkWriteQueueHigh()
+	{
+		if(!writeQueueIsHigh && writeQueueFull())
+			setWriteQueueHigh();
+	}
+
+	void setWriteQueueHigh()
+	{
+		writeQueueIsHigh = true;
+		pendingWriteQueueHigh = true;
+		update();
+	}
+
+	bool write(const QList<QByteArray> &message)
+	{
+		assert(!message.isEmpty());
+
+		if(writeQueueEnabled)
+		{
+			if(writeQueueFull())
+			{
+				checkWriteQueueHigh();
+				return false;
+			}
+
+			bool ok = enqueue(message);
+
+			if(canWrite && writePending())
+				update();
+
+			checkWriteQueueHigh();
+			return ok;
+		}
+		else
+		{
+			bool ok = false;
+			if(finishInFlight())
+				ok = writeMessage(message);
+
+			processEvents();
+
+			if(pendingWritten > 0 || canRead)
+				update();
+
+			return ok;
+		}
+	}
+
+	bool writeFrames(const QList<Frame> &message)
+	{
+		assert(!message.isEmpty());
+
+		// the frames can only go straight to zmq if nothing is ahead of
+		//   them. otherwise, or if zmq refuses them, they are copied into
+		//   the write queue like any other message
+		if(!ioThread && inFlight.isEmpty() && pendingWrites.isEmpty() && peerWrites.isEmpty())
+		{
+			int pos = 0;
+			int e = 0;
+			bool done = zmqWriteFrames(message, &pos, &e);
+
+			if(done || pos > 0 || e == EHOSTUNREACH || !writeQueueEnabled)
+			{
+				if(done)
+				{
+					recordWritten(message);
+				}
+				else if(pos > 0)
+				{
+					// frame data can't be kept in flight, so copy it. the
+					//   whole message is kept, as in writeMessage, so that
+					//   stats and capture see all of it once completed
+					inFlight = toByteArrays(message);
+					inFlightPos = pos;
+
+					// never queued, so there is no wait to record
+					inFlightTime = -1;
+				}
+
+				processEvents();
+
+				if(pendingWritten > 0 || (canWrite && writePending()) || canRead)
+					update();
+
+				return (done || pos > 0);
+			}
+		}
+
+		return write(toByteArrays(message));
+	}
+
+	static QList<QByteArray> toByteArrays(const QList<Frame> &frames)
+	{
+		QList<QByteArray> out;
+		foreach(const Frame &f, frames)
+			out += f.toByteArray();
+		return out;
+	}
+
+	int writeBatch(const QList< QList<QByteArray> > &messages)
+	{
+		if(messages.isEmpty())
+			return 0;
+
+		int accepted = 0;
 
 		if(writeQueueEnabled)
 		{
-			pendingWrites += message;
+			if(!peerQueuesEnabled)
+				pendingWrites.reserve(pendingWrites.count() + messages.count());
 
-			if(canWrite)
+			foreach(const QList<QByteArray> &message, messages)
+			{
+				assert(!message.isEmpty());
+
+				if(writeQueueFull())
+					break;
+
+				// stop at the first refusal (e.g. a router peer at its
+				//   limit), so that the accepted messages are a prefix
+				if(!enqueue(message))
+					break;
+
+				++accepted;
+			}
+
+			bool full = writeQueueFull();
+
+			// flush what we can right away. messagesWritten is emitted
+			//   later, once, for everything that was written
+			tryWrite();
+
+			if(pendingWritten > 0 || (canWrite && writePending()) || canRead)
 				update();
+
+			if(full && !writeQueueIsHigh)
+				setWriteQueueHigh();
 		}
 		else
 		{
-			if(zmqWrite(message))
+			if(finishInFlight())
 			{
-				++pendingWritten;
+				foreach(const QList<QByteArray> &message, messages)
+				{
+					assert(!message.isEmpty());
+
+					// once a write fails, the rest would be dropped too.
+					//   a message that is only partly written is finished
+					//   later, and nothing else may be written until then
+					if(!writeMessage(message))
+						break;
+
+					++accepted;
+
+					if(!inFlight.isEmpty())
+						break;
+				}
 			}
 
 			processEvents();
@@ -512,12 +1730,26 @@ public:
 			if(pendingWritten > 0 || canRead)
 				update();
 		}
+
+		return accepted;
 	}
 
 	// return true if flags changed
 	bool processEvents()
 	{
-		int flags = get_events(sock);
+		int flags;
+		if(ioThread)
+		{
+			// with an i/o thread, readability and writability refer to
+			//   the queues shared with it
+			flags = 0;
+			if(!ioThread->incoming.isEmpty())
+				flags |= ZMQ_POLLIN;
+			if(!ioThread->outgoing.isFull())
+				flags |= ZMQ_POLLOUT;
+		}
+		else
+			flags = get_events(sock);
 
 		bool canWriteOld = canWrite;
 		bool canReadOld = canRead;
@@ -528,18 +1760,87 @@ public:
 		return (canWrite != canWriteOld || canRead != canReadOld);
 	}
 
-	bool zmqWrite(const QList<QByteArray> &message)
+	// writes the parts of message starting at *pos, advancing *pos as each
+	//   part is accepted, so that a failed write can be resumed where it
+	//   left off. returns true once the last part has been written. on
+	//   failure, the zmq error code is stored in error, if not null
+	bool zmqWrite(const QList<QByteArray> &message, int *pos, int *error = 0)
 	{
-		for(int n = 0; n < message.count(); ++n)
+		if(ioThread)
+		{
+			// messages are handed over whole. the rest of a message that
+			//   was partly written before the thread started is handed
+			//   over as if it were whole, and the thread completes it
+			if(ioThread->outgoing.push(*pos == 0 ? message : message.mid(*pos)))
+			{
+				*pos = message.count();
+				ioThread->wake();
+				return true;
+			}
+
+			// note: a full queue to the thread is not zmq refusing the
+			//   write, so it isn't counted as such
+
+			if(error)
+				*error = EAGAIN;
+
+			return false;
+		}
+
+		for(; *pos < message.count(); ++(*pos))
 		{
+			int n = *pos;
 			const QByteArray &buf = message[n];
 
 			zmq_msg_t msg;
+			init_msg(&msg, buf, zeroCopyWriteThreshold);
+
+			int ret;
+#ifdef USE_MSG_IO
+			ret = zmq_msg_send(&msg, sock, ZMQ_DONTWAIT | (n + 1 < message.count() ? ZMQ_SNDMORE : 0));
+#else
+			ret = zmq_send(sock, &msg, ZMQ_NOBLOCK | (n + 1 < message.count() ? ZMQ_SNDMORE : 0));
+#endif
+
+			if(ret < 0)
+			{
+				if(errno == EAGAIN)
+					++stats.writesRefused;
+
+				if(error)
+					*error = errno;
+
+				ret = zmq_msg_close(&msg);
+				assert(ret == 0);
+
+				return false;
+			}
+
+			ret = zmq_msg_close(&msg);
+			assert(ret == 0);
+		}
+
+		return true;
+	}
+
+	// like zmqWrite, but for frames. zmq shares the underlying data rather
+	//   than copying it
+	bool zmqWriteFrames(const QList<Frame> &message, int *pos, int *error = 0)
+	{
+		for(; *pos < message.count(); ++(*pos))
+		{
+			int n = *pos;
 
-			int ret = zmq_msg_init_size(&msg, buf.size());
+			zmq_msg_t msg;
+			int ret = zmq_msg_init(&msg);
 			assert(ret == 0);
 
-			memcpy(zmq_msg_data(&msg), buf.data(), buf.size());
+			zmq_msg_t *src = (zmq_msg_t *)message[n].message();
+			if(src)
+			{
+				ret = zmq_msg_copy(&msg, src);
+				assert(ret == 0);
+			}
 
 #ifdef USE_MSG_IO
 			ret = zmq_msg_send(&msg, sock, ZMQ_DONTWAIT | (n + 1 < message.count() ? ZMQ_SNDMORE : 0));
@@ -549,6 +1850,12 @@ public:
 
 			if(ret < 0)
 			{
+				if(errno == EAGAIN)
+					++stats.writesRefused;
+
+				if(error)
+					*error = errno;
+
 				ret = zmq_msg_close(&msg);
 				assert(ret == 0);
 
@@ -562,31 +1869,167 @@ public:
 		return true;
 	}
 
+	// attempts to write a message. returns true if zmq has taken it, in
+	//   which case the caller should consider it gone. if only some of
+	//   the parts could be written, the rest are kept in flight and
+	//   completed by finishInFlight. must not be called while a message is
+	//   in flight. queuedAt is when the message was queued, if known
+	bool writeMessage(const QList<QByteArray> &message, int *error = 0, qint64 queuedAt = -1)
+	{
+		assert(inFlight.isEmpty());
+
+		int pos = 0;
+		if(zmqWrite(message, &pos, error))
+		{
+			recordWritten(message);
+			recordWriteLatency(queuedAt);
+			return true;
+		}
+
+		if(pos > 0)
+		{
+			inFlight = message;
+			inFlightPos = pos;
+			inFlightTime = queuedAt;
+			return true;
+		}
+
+		return false;
+	}
+
+	// returns true if there is no partly written message, either because
+	//   there wasn't one or because it has now been completed
+	bool finishInFlight()
+	{
+		if(inFlight.isEmpty())
+			return true;
+
+		int e = 0;
+		if(zmqWrite(inFlight, &inFlightPos, &e))
+		{
+			recordWritten(inFlight);
+			recordWriteLatency(inFlightTime);
+			inFlight.clear();
+			inFlightPos = 0;
+			inFlightTime = -1;
+			return true;
+		}
+
+		if(e != EAGAIN && e != EINTR)
+		{
+			// can't be completed
+			++stats.messagesDropped;
+			inFlight.clear();
+			inFlightPos = 0;
+			inFlightTime = -1;
+			return true;
+		}
+
+		return false;
+	}
+
 	void tryWrite()
 	{
-		while(canWrite && !pendingWrites.isEmpty())
+		if(!canWrite || !writePending())
+			return;
+
+		if(finishInFlight())
+		{
+			int count = 0;
+			while(!pendingWrites.isEmpty())
+			{
+				if(maxWritesPerEvent >= 0 && count >= maxWritesPerEvent)
+				{
+					// continue in the next pass
+					update();
+					break;
+				}
+
+				int e = 0;
+				if(writeMessage(pendingWrites.first(), &e, pendingWrites.firstTime()) || e == EHOSTUNREACH)
+				{
+					// note: if the router peer is gone, there's nothing
+					//   to do but drop
+					if(e == EHOSTUNREACH)
+						++stats.messagesDropped;
+
+					pendingWrites.removeFirst();
+				}
+				else
+					break;
+
+				++count;
+
+				if(!inFlight.isEmpty())
+					break;
+			}
+
+			if(inFlight.isEmpty() && pendingWrites.isEmpty() && !peerWrites.isEmpty() && !peersBlocked)
+				tryWritePeers(count);
+		}
+
+		// keep writing until zmq refuses, and only then check the socket
+		//   state, rather than after every message
+		processEvents();
+	}
+
+	void tryWritePeers(int count)
+	{
+		// visit the peers in turn, writing one message each. a peer that
+		//   can't take a message is skipped, so it only holds up its own
+		//   messages. we stop once every peer has been skipped in a row
+		int skipped = 0;
+		while(!peerWrites.isEmpty() && skipped < peerWrites.peerCount())
 		{
-			// whether this write succeeds or not, we assume we
-			//   can't write afterwards
-			canWrite = false;
+			if(maxWritesPerEvent >= 0 && count >= maxWritesPerEvent)
+			{
+				update();
+				break;
+			}
 
-			if(zmqWrite(pendingWrites.first()))
+			int e = 0;
+			if(writeMessage(peerWrites.current(), &e, peerWrites.currentTime()))
+			{
+				peerWrites.removeCurrent();
+				skipped = 0;
+			}
+			else if(e == EHOSTUNREACH)
+			{
+				// peer is gone. its other messages would fail the same way
+				stats.messagesDropped += peerWrites.peerQueueCount(peerWrites.current().first());
+				peerWrites.removeCurrentPeer();
+				skipped = 0;
+			}
+			else
 			{
-				pendingWrites.removeFirst();
-				++pendingWritten;
+				peerWrites.skipCurrent();
+				++skipped;
 			}
 
-			processEvents();
+			++count;
+
+			// the other peers have to wait for a partly written message
+			if(!inFlight.isEmpty())
+				break;
 		}
+
+		// if all peers are blocked, wait for zmq to signal activity before
+		//   trying again. otherwise we'd spin, since a router socket is
+		//   writable as long as any one peer is
+		if(!peerWrites.isEmpty() && skipped >= peerWrites.peerCount())
+			peersBlocked = true;
 	}
 
 	void doUpdate()
 	{
 		tryWrite();
 
+		reportStats();
+
+		QPointer<QObject> self = this;
+
 		if(canRead)
 		{
-			QPointer<QObject> self = this;
 			emit q->readyRead();
 			if(!self)
 				return;
@@ -598,13 +2041,85 @@ public:
 			pendingWritten = 0;
 
 			emit q->messagesWritten(count);
+			if(!self)
+				return;
+		}
+
+		if(pendingWriteQueueHigh)
+		{
+			pendingWriteQueueHigh = false;
+
+			emit q->writeQueueHigh();
+			if(!self)
+				return;
+		}
+
+		if(writeQueueIsHigh && writeQueueDrained())
+		{
+			writeQueueIsHigh = false;
+
+			emit q->writeQueueLow();
+		}
+	}
+
+	void startIoThread(int queueSize)
+	{
+		if(ioThread)
+			return;
+
+		// router peer queues don't work with the thread, which writes one
+		//   message at a time. with ZMQ_ROUTER_MANDATORY, a slow peer would
+		//   block everything behind it and the thread would spin, since the
+		//   socket is writable as long as any peer is. fall back to a plain
+		//   router, keeping the order of anything already queued per peer
+		if(peerQueuesEnabled)
+		{
+			while(!peerWrites.isEmpty())
+			{
+				pendingWrites.append(peerWrites.current(), peerWrites.currentTime());
+				peerWrites.removeCurrent();
+			}
+
+			peerQueuesEnabled = false;
+			peersBlocked = false;
+			set_router_mandatory(sock, false);
 		}
+
+		// the thread owns the socket from now on
+		sn_read->setEnabled(false);
+
+		ioThread = new IoThread(context->context(), sock, this, "io_activity", queueSize, zeroCopyWriteThreshold);
+		ioThread->start();
+
+		processEvents();
+		if((canWrite && writePending()) || canRead)
+			update();
 	}
 
 public slots:
+	void io_activity()
+	{
+		ioThread->clearNotify();
+
+		sn_read_activated();
+	}
+
 	void sn_read_activated()
 	{
-		if(!processEvents())
+		++stats.notifierWakeups;
+
+		bool changed = processEvents();
+
+		// activity on the socket may mean a blocked peer can accept
+		//   messages again
+		if(peersBlocked)
+		{
+			peersBlocked = false;
+			if(canWrite)
+				changed = true;
+		}
+
+		if(!changed)
 			return;
 
 		if(pendingUpdate)
@@ -618,6 +2133,8 @@ public slots:
 
 	void update_timeout()
 	{
+		++stats.updateWakeups;
+
 		pendingUpdate = false;
 
 		doUpdate();
@@ -641,6 +2158,25 @@ Socket::~Socket()
 	delete d;
 }
 
+void *Socket::zmqSocket() const
+{
+	return d->sock;
+}
+
+Socket *Socket::createPeer(Type type, QObject *parent) const
+{
+	Socket *sock = new Socket(type, d->context, parent);
+
+	// hold the same global reference we do, so the context outlives both
+	if(d->global)
+	{
+		refGlobalContext(d->global);
+		sock->d->global = d->global;
+	}
+
+	return sock;
+}
+
 void Socket::setShutdownWaitTime(int msecs)
 {
 	d->shutdownWaitTime = msecs;
@@ -651,6 +2187,48 @@ void Socket::setWriteQueueEnabled(bool enable)
 	d->writeQueueEnabled = enable;
 }
 
+void Socket::setWriteQueueLimits(int maxMessages, qint64 maxBytes)
+{
+	d->maxQueuedMessages = maxMessages;
+	d->maxQueuedBytes = maxBytes;
+}
+
+bool Socket::isWriteQueueFull() const
+{
+	return d->writeQueueFull();
+}
+
+void Socket::setRouterPeerQueuesEnabled(bool enable)
+{
+	// only routers have peers, and not supported with the i/o thread (see
+	//   startIoThread)
+	if(d->type != Router || d->ioThread)
+		return;
+
+	d->peerQueuesEnabled = enable;
+	set_router_mandatory(d->sock, enable);
+}
+
+void Socket::setRouterPeerQueueLimit(int maxMessages)
+{
+	d->maxQueuedPerPeer = maxMessages;
+}
+
+void Socket::startIoThread(int queueSize)
+{
+	d->startIoThread(queueSize);
+}
+
+void Socket::setZeroCopyWriteThreshold(int size)
+{
+	d->zeroCopyWriteThreshold = size;
+}
+
+void Socket::setMaxWritesPerEvent(int max)
+{
+	d->maxWritesPerEvent = max;
+}
+
 void Socket::subscribe(const QByteArray &filter)
 {
 	set_subscribe(d->sock, filter.data(), filter.size());
@@ -720,6 +2298,102 @@ void Socket::setTcpKeepAliveParameters(int idle, int count, int interval)
 	set_tcp_keepalive_intvl(d->sock, interval);
 }
 
+quint64 Socket::affinity() const
+{
+	return get_affinity(d->sock);
+}
+
+void Socket::setAffinity(quint64 mask)
+{
+	set_affinity(d->sock, mask);
+}
+
+int Socket::sendBufferSize() const
+{
+	return get_sndbuf(d->sock);
+}
+
+int Socket::receiveBufferSize() const
+{
+	return get_rcvbuf(d->sock);
+}
+
+void Socket::setSendBufferSize(int size)
+{
+	set_sndbuf(d->sock, size);
+}
+
+void Socket::setReceiveBufferSize(int size)
+{
+	set_rcvbuf(d->sock, size);
+}
+
+void Socket::setBacklog(int size)
+{
+	set_backlog(d->sock, size);
+}
+
+void Socket::setTypeOfService(int tos)
+{
+	set_tos(d->sock, tos);
+}
+
+void Socket::setMaxMessageSize(qint64 size)
+{
+	set_maxmsgsize(d->sock, size);
+}
+
+void Socket::setWriteLatencyTrackingEnabled(bool enable)
+{
+	if(enable && !d->latencyClock.isValid())
+		d->latencyClock.start();
+
+	d->trackWriteLatency = enable;
+}
+
+LatencyHistogram Socket::writeLatency() const
+{
+	return d->writeLatency;
+}
+
+void Socket::resetWriteLatency()
+{
+	d->writeLatency.reset();
+}
+
+void Socket::setCapture(Capture *capture)
+{
+	d->capture = capture;
+}
+
+SocketStats Socket::stats() const
+{
+	return d->currentStats();
+}
+
+void Socket::resetStats()
+{
+	// keep the process-wide totals consistent
+	d->reportStats();
+
+	d->stats = SocketStats();
+	d->reportedStats = SocketStats();
+	d->reportedStats.writeQueueDepth = d->queuedCount();
+	d->reportedStats.writeQueueBytes = d->queuedBytes();
+}
+
+void Socket::setGlobalStatsEnabled(bool enable)
+{
+	g_stats()->enabled.storeRelease(enable ? 1 : 0);
+}
+
+SocketStats Socket::globalStats()
+{
+	GlobalStats *g = g_stats();
+	QMutexLocker locker(&g->mutex);
+	return g->stats;
+}
+
 void Socket::connectToAddress(const QString &addr)
 {
 	int ret = zmq_connect(d->sock, addr.toUtf8().data());
@@ -750,9 +2424,29 @@ QList<QByteArray> Socket::read()
 	return d->read();
 }
 
-void Socket::write(const QList<QByteArray> &message)
+QList<Frame> Socket::readFrames()
+{
+	return d->readFrames();
+}
+
+QList< QList<QByteArray> > Socket::readBatch(int maxMessages, int maxBytes)
+{
+	return d->readBatch(maxMessages, maxBytes);
+}
+
+bool Socket::write(const QList<QByteArray> &message)
+{
+	return d->write(message);
+}
+
+int Socket::writeBatch(const QList< QList<QByteArray> > &messages)
+{
+	return d->writeBatch(messages);
+}
+
+bool Socket::writeFrames(const QList<Frame> &message)
 {
-	d->write(message);
+	return d->writeFrames(message);
 }
 
 }
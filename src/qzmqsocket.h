@@ -25,10 +25,14 @@
 #define QZMQSOCKET_H
 
 #include <QObject>
+#include "qzmqframe.h"
+#include "qzmqsocketstats.h"
+#include "qzmqlatencyhistogram.h"
 
 namespace QZmq {
 
 class Context;
+class Capture;
 
 class Socket : public QObject
 {
@@ -64,6 +68,51 @@ public:
 	//   blocking policy.
 	void setWriteQueueEnabled(bool enable);
 
+	// limits on the write queue, in messages and in total bytes. -1 means
+	//   no limit (default = -1). once a limit is reached, writeQueueHigh is
+	//   emitted and further writes are refused until there is room again.
+	//   writeQueueLow is emitted once the queue has drained to half of the
+	//   limits
+	void setWriteQueueLimits(int maxMessages, qint64 maxBytes = -1);
+
+	bool isWriteQueueFull() const;
+
+	// for router sockets. if enabled, queued messages are kept in a
+	//   separate queue per peer, keyed by the first frame (the routing
+	//   identity), and peers are written to in round-robin order. this way
+	//   a peer that can't keep up only delays its own messages. this also
+	//   enables ZMQ_ROUTER_MANDATORY, and messages for unknown peers are
+	//   dropped. ignored for other socket types, and once the i/o thread
+	//   is started (see startIoThread). default disabled
+	void setRouterPeerQueuesEnabled(bool enable);
+
+	// the maximum number of queued messages per peer, beyond which writes
+	//   to that peer are refused. -1 means no limit (default = -1)
+	void setRouterPeerQueueLimit(int maxMessages);
+
+	// frames of at least this many bytes are handed to zmq without being
+	//   copied. a reference to the QByteArray is held until zmq is done
+	//   with the data, so the content must not be raw data (see
+	//   QByteArray::fromRawData). this saves a copy for large frames at the
+	//   cost of an allocation per frame. -1 means never (default = -1)
+	void setZeroCopyWriteThreshold(int size);
+
+	// moves the socket i/o to a dedicated thread, so that throughput isn't
+	//   limited by how busy the owning thread is. messages are passed
+	//   between the threads through lock-free queues of the given size,
+	//   and messagesWritten then means messages were handed to the i/o
+	//   thread. the thread runs until the socket is destroyed. all
+	//   options must be set, and connectToAddress/bind called, before
+	//   starting it. router peer queues are not supported in this mode:
+	//   starting the thread disables them, along with
+	//   ZMQ_ROUTER_MANDATORY, and messages already queued per peer are
+	//   kept and written in turn order
+	void startIoThread(int queueSize = 1024);
+
+	// the maximum number of queued messages to write to zmq in one pass
+	//   before returning to the event loop. -1 means no limit (default = -1)
+	void setMaxWritesPerEvent(int max);
+
 	void subscribe(const QByteArray &filter);
 	void unsubscribe(const QByteArray &filter);
 
@@ -84,11 +133,58 @@ public:
 	void setTcpKeepAliveEnabled(bool on);
 	void setTcpKeepAliveParameters(int idle = -1, int count = -1, int interval = -1);
 
+	// bitmask of the context's i/o threads that may handle connections
+	//   made by subsequent connectToAddress/bind calls. 0 means any
+	//   (default = 0)
+	quint64 affinity() const;
+	void setAffinity(quint64 mask);
+
+	// kernel socket buffer sizes, in bytes. 0 or -1 means the os default,
+	//   depending on zmq version
+	int sendBufferSize() const;
+	int receiveBufferSize() const;
+	void setSendBufferSize(int size);
+	void setReceiveBufferSize(int size);
+
+	// maximum length of the queue of pending incoming connections
+	void setBacklog(int size);
+
+	// ip type-of-service for outgoing packets. ignored if not supported
+	//   by the zmq version
+	void setTypeOfService(int tos);
+
+	// peers sending larger messages are disconnected. -1 means no limit.
+	//   ignored if not supported by the zmq version (default = -1)
+	void setMaxMessageSize(qint64 size);
+
 	void connectToAddress(const QString &addr);
 	bool bind(const QString &addr);
 
 	bool canRead() const;
 
+	// counters since creation or the last reset. taking a snapshot is
+	//   cheap, but must be done from the thread the socket lives in
+	SocketStats stats() const;
+	void resetStats();
+
+	// if enabled, sockets add their counters to process-wide totals from
+	//   time to time, and when destroyed. the totals may be read from any
+	//   thread (default disabled)
+	static void setGlobalStatsEnabled(bool enable);
+	static SocketStats globalStats();
+
+	// if enabled, the time each message spends in the write queue before
+	//   zmq takes it is recorded, in nanoseconds. only messages queued
+	//   while enabled are counted (default disabled)
+	void setWriteLatencyTrackingEnabled(bool enable);
+	LatencyHistogram writeLatency() const;
+	void resetWriteLatency();
+
+	// records messages read, and messages written once zmq has taken
+	//   them, into the capture. the capture is not owned, and must be
+	//   unset or outlive the socket. 0 means none (default = 0)
+	void setCapture(Capture *capture);
+
 	// returns true if this object believes the next write to zmq will
 	//   succeed immediately. note that it starts out false until the
 	//   value is discovered. also note that the write could still end up
@@ -96,11 +192,41 @@ public:
 	bool canWriteImmediately() const;
 
 	QList<QByteArray> read();
-	void write(const QList<QByteArray> &message);
+
+	// like read(), but the parts are returned as frames that refer to the
+	//   memory owned by zmq rather than being copied
+	QList<Frame> readFrames();
+
+	// reads as many messages as are available, up to maxMessages, or until
+	//   at least maxBytes have been read. messages are never split, so the
+	//   byte limit may be exceeded by the last one. -1 means no limit. this
+	//   is cheaper than calling read() repeatedly, since the socket state
+	//   is only checked once at the end
+	QList< QList<QByteArray> > readBatch(int maxMessages, int maxBytes = -1);
+
+	// returns false if the message was dropped, either because the write
+	//   queue is full or, with the queue disabled, because zmq refused it
+	bool write(const QList<QByteArray> &message);
+
+	// writes many messages at once. with the write queue enabled, as many
+	//   as possible are passed to zmq immediately and the rest are queued.
+	//   either way, messagesWritten reports everything written in a pass
+	//   with a single emission, rather than once per message. returns the
+	//   number of messages accepted, which are always the first ones.
+	//   accepting stops at the first message refused, including by a
+	//   router peer queue limit
+	int writeBatch(const QList< QList<QByteArray> > &messages);
+
+	// writes frames, such as those from readFrames(), without copying the
+	//   data when they can be passed to zmq right away. if they have to be
+	//   queued, the data is copied. returns false if the message was dropped
+	bool writeFrames(const QList<Frame> &message);
 
 signals:
 	void readyRead();
 	void messagesWritten(int count);
+	void writeQueueHigh();
+	void writeQueueLow();
 
 private:
 	Q_DISABLE_COPY(Socket)
@@ -108,6 +234,15 @@ private:
 	class Private;
 	friend class Private;
 	Private *d;
+
+	friend class Monitor;
+
+	// for Monitor
+	void *zmqSocket() const;
+
+	// creates a socket in the same context as this one. if that is the
+	//   global context, the new socket holds its own reference to it
+	Socket *createPeer(Type type, QObject *parent) const;
 };
 
 }
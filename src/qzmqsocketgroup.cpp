@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqsocketgroup.h"
+
+#include <assert.h>
+#include <QThread>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QMetaType>
+#include "qzmqsocket.h"
+
+namespace QZmq {
+
+// lives in one of the pool threads, and handles the sockets there
+class SocketGroupWorker : public QObject
+{
+	Q_OBJECT
+
+public:
+	int maxReadsPerEvent;
+	QSet<Socket*> sockets;
+	QSet<Socket*> pendingReads;
+
+	SocketGroupWorker() :
+		maxReadsPerEvent(100)
+	{
+	}
+
+	void queueRead(Socket *sock)
+	{
+		if(pendingReads.contains(sock))
+			return;
+
+		pendingReads += sock;
+		QMetaObject::invokeMethod(this, "queuedRead", Qt::QueuedConnection, Q_ARG(QZmq::Socket*, sock));
+	}
+
+	void tryRead(Socket *sock)
+	{
+		if(!sock->canRead())
+			return;
+
+		QList< QList<QByteArray> > messages = sock->readBatch(maxReadsPerEvent);
+		if(!messages.isEmpty())
+			emit readyRead(sock, messages);
+
+		// let the other sockets in this thread have a turn
+		if(sock->canRead())
+			queueRead(sock);
+	}
+
+signals:
+	void readyRead(QZmq::Socket *sock, const QList< QList<QByteArray> > &messages);
+	void messagesWritten(QZmq::Socket *sock, int count);
+
+public slots:
+	void setMaxReadsPerEvent(int max)
+	{
+		maxReadsPerEvent = max;
+	}
+
+	void addSocket(QZmq::Socket *sock)
+	{
+		sockets += sock;
+		sock->setParent(this);
+
+		connect(sock, SIGNAL(readyRead()), SLOT(sock_readyRead()));
+		connect(sock, SIGNAL(messagesWritten(int)), SLOT(sock_messagesWritten(int)));
+
+		// it may have been readable before the move
+		if(sock->canRead())
+			queueRead(sock);
+	}
+
+	void removeSocket(QZmq::Socket *sock)
+	{
+		if(!sockets.contains(sock))
+			return;
+
+		sockets.remove(sock);
+		pendingReads.remove(sock);
+		delete sock;
+	}
+
+	void write(QZmq::Socket *sock, const QList<QByteArray> &message)
+	{
+		if(sockets.contains(sock))
+			sock->write(message);
+	}
+
+	void shutdown()
+	{
+		qDeleteAll(sockets);
+		sockets.clear();
+		pendingReads.clear();
+	}
+
+	void queuedRead(QZmq::Socket *sock)
+	{
+		if(!pendingReads.contains(sock))
+			return;
+
+		pendingReads.remove(sock);
+		tryRead(sock);
+	}
+
+	void sock_readyRead()
+	{
+		Socket *sock = static_cast<Socket*>(sender());
+		if(pendingReads.contains(sock))
+			return;
+
+		tryRead(sock);
+	}
+
+	void sock_messagesWritten(int count)
+	{
+		emit messagesWritten(static_cast<Socket*>(sender()), count);
+	}
+};
+
+class SocketGroup::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	class Thread
+	{
+	public:
+		QThread *thread;
+		SocketGroupWorker *worker;
+	};
+
+	SocketGroup *q;
+	QList<Thread> threads;
+	QHash<Socket*, int> socketThreads;
+	SocketGroup::Policy policy;
+	int next;
+
+	Private(SocketGroup *_q, int threadCount) :
+		QObject(_q),
+		q(_q),
+		policy(SocketGroup::RoundRobin),
+		next(0)
+	{
+		qRegisterMetaType<QZmq::Socket*>("QZmq::Socket*");
+		qRegisterMetaType< QList<QByteArray> >("QList<QByteArray>");
+		qRegisterMetaType< QList< QList<QByteArray> > >("QList<QList<QByteArray> >");
+
+		if(threadCount < 1)
+			threadCount = qMax(QThread::idealThreadCount(), 1);
+
+		for(int n = 0; n < threadCount; ++n)
+		{
+			Thread t;
+			t.thread = new QThread;
+			t.worker = new SocketGroupWorker;
+			t.worker->moveToThread(t.thread);
+			connect(t.worker, SIGNAL(readyRead(QZmq::Socket*, const QList< QList<QByteArray> > &)), SLOT(worker_readyRead(QZmq::Socket*, const QList< QList<QByteArray> > &)));
+			connect(t.worker, SIGNAL(messagesWritten(QZmq::Socket*, int)), SLOT(worker_messagesWritten(QZmq::Socket*, int)));
+			t.thread->start();
+			threads += t;
+		}
+	}
+
+	~Private()
+	{
+		foreach(const Thread &t, threads)
+		{
+			t.worker->disconnect(this);
+
+			// sockets must be destroyed in the thread they live in
+			QMetaObject::invokeMethod(t.worker, "shutdown", Qt::BlockingQueuedConnection);
+
+			t.thread->quit();
+			t.thread->wait();
+			delete t.worker;
+			delete t.thread;
+		}
+	}
+
+	int pickThread(const QString &endpoint)
+	{
+		if(policy == SocketGroup::EndpointHash && !endpoint.isEmpty())
+			return (int)(qHash(endpoint) % (uint)threads.count());
+
+		int index = next;
+		next = (next + 1) % threads.count();
+		return index;
+	}
+
+	int addSocket(Socket *sock, const QString &endpoint)
+	{
+		assert(!sock->parent());
+		assert(!socketThreads.contains(sock));
+
+		int index = pickThread(endpoint);
+		socketThreads.insert(sock, index);
+
+		SocketGroupWorker *worker = threads[index].worker;
+		sock->moveToThread(worker->thread());
+		QMetaObject::invokeMethod(worker, "addSocket", Qt::QueuedConnection, Q_ARG(QZmq::Socket*, sock));
+
+		return index;
+	}
+
+	void removeSocket(Socket *sock)
+	{
+		if(!socketThreads.contains(sock))
+			return;
+
+		int index = socketThreads.take(sock);
+		QMetaObject::invokeMethod(threads[index].worker, "removeSocket", Qt::QueuedConnection, Q_ARG(QZmq::Socket*, sock));
+	}
+
+public slots:
+	void worker_readyRead(QZmq::Socket *sock, const QList< QList<QByteArray> > &messages)
+	{
+		QPointer<QObject> self = this;
+
+		foreach(const QList<QByteArray> &message, messages)
+		{
+			// removed in the meantime?
+			if(!socketThreads.contains(sock))
+				return;
+
+			emit q->readyRead(sock, message);
+			if(!self)
+				return;
+		}
+	}
+
+	void worker_messagesWritten(QZmq::Socket *sock, int count)
+	{
+		if(socketThreads.contains(sock))
+			emit q->messagesWritten(sock, count);
+	}
+};
+
+SocketGroup::SocketGroup(int threadCount, QObject *parent) :
+	QObject(parent)
+{
+	d = new Private(this, threadCount);
+}
+
+SocketGroup::~SocketGroup()
+{
+	delete d;
+}
+
+int SocketGroup::threadCount() const
+{
+	return d->threads.count();
+}
+
+void SocketGroup::setPolicy(Policy policy)
+{
+	d->policy = policy;
+}
+
+void SocketGroup::setMaxReadsPerEvent(int max)
+{
+	foreach(const Private::Thread &t, d->threads)
+	{
+		QMetaObject::invokeMethod(t.worker, "setMaxReadsPerEvent", Qt::QueuedConnection, Q_ARG(int, max));
+	}
+}
+
+int SocketGroup::addSocket(Socket *sock, const QString &endpoint)
+{
+	return d->addSocket(sock, endpoint);
+}
+
+void SocketGroup::removeSocket(Socket *sock)
+{
+	d->removeSocket(sock);
+}
+
+void SocketGroup::write(Socket *sock, const QList<QByteArray> &message)
+{
+	if(!d->socketThreads.contains(sock))
+		return;
+
+	SocketGroupWorker *worker = d->threads[d->socketThreads.value(sock)].worker;
+	QMetaObject::invokeMethod(worker, "write", Qt::QueuedConnection, Q_ARG(QZmq::Socket*, sock), Q_ARG(QList<QByteArray>, message));
+}
+
+}
+
+#include "qzmqsocketgroup.moc"
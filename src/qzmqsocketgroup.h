@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQSOCKETGROUP_H
+#define QZMQSOCKETGROUP_H
+
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+
+class QThread;
+
+namespace QZmq {
+
+class Socket;
+
+// spreads sockets over a pool of threads, each running its own event
+//   loop, so that socket handling isn't limited to one core. messages
+//   read are delivered via readyRead in the thread the group lives in,
+//   and writes are passed to the thread of the socket
+class SocketGroup : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum Policy
+	{
+		RoundRobin,
+		EndpointHash
+	};
+
+	// threadCount of -1 means one thread per core
+	SocketGroup(int threadCount = -1, QObject *parent = 0);
+	~SocketGroup();
+
+	int threadCount() const;
+
+	// how sockets are assigned to threads. with EndpointHash, sockets
+	//   added with the same endpoint always land on the same thread
+	//   (default = RoundRobin)
+	void setPolicy(Policy policy);
+
+	// the maximum number of messages to read from a socket in one pass
+	//   (default = 100)
+	void setMaxReadsPerEvent(int max);
+
+	// takes ownership of the socket and moves it to one of the threads.
+	//   the socket must have no parent, and should be fully set up
+	//   (options, connectToAddress/bind) beforehand, since it must not be
+	//   touched directly afterwards. returns the index of the thread
+	//   chosen
+	int addSocket(Socket *sock, const QString &endpoint = QString());
+
+	// destroys the socket, in its own thread
+	void removeSocket(Socket *sock);
+
+	// the write happens in the thread of the socket. messagesWritten
+	//   is reported back the same way
+	void write(Socket *sock, const QList<QByteArray> &message);
+
+signals:
+	void readyRead(QZmq::Socket *sock, const QList<QByteArray> &message);
+	void messagesWritten(QZmq::Socket *sock, int count);
+
+private:
+	Q_DISABLE_COPY(SocketGroup)
+
+	class Private;
+	friend class Private;
+	Private *d;
+};
+
+}
+
+#endif
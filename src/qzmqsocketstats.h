@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQSOCKETSTATS_H
+#define QZMQSOCKETSTATS_H
+
+#include <QtGlobal>
+
+namespace QZmq {
+
+class SocketStats
+{
+public:
+	qint64 messagesRead;
+	qint64 framesRead;
+	qint64 bytesRead;
+
+	// counted once zmq has taken the whole message
+	qint64 messagesWritten;
+	qint64 framesWritten;
+	qint64 bytesWritten;
+
+	// messages given up on, because the router peer was gone or the rest
+	//   of a partly written message couldn't be sent
+	qint64 messagesDropped;
+
+	// write attempts refused by zmq because it couldn't take more (EAGAIN)
+	qint64 writesRefused;
+
+	// messages in the write queue, at the time of the snapshot, and the
+	//   most there have been
+	qint64 writeQueueDepth;
+	qint64 writeQueueBytes;
+	qint64 writeQueueHighWatermark;
+
+	// times the socket woke up to do work, via the update timer or via
+	//   activity on the zmq socket
+	qint64 updateWakeups;
+	qint64 notifierWakeups;
+
+	SocketStats() :
+		messagesRead(0),
+		framesRead(0),
+		bytesRead(0),
+		messagesWritten(0),
+		framesWritten(0),
+		bytesWritten(0),
+		messagesDropped(0),
+		writesRefused(0),
+		writeQueueDepth(0),
+		writeQueueBytes(0),
+		writeQueueHighWatermark(0),
+		updateWakeups(0),
+		notifierWakeups(0)
+	{
+	}
+
+	// for aggregating. queue depths are summed, and the high watermark is
+	//   the highest of the two
+	SocketStats & operator+=(const SocketStats &other)
+	{
+		messagesRead += other.messagesRead;
+		framesRead += other.framesRead;
+		bytesRead += other.bytesRead;
+		messagesWritten += other.messagesWritten;
+		framesWritten += other.framesWritten;
+		bytesWritten += other.bytesWritten;
+		messagesDropped += other.messagesDropped;
+		writesRefused += other.writesRefused;
+		writeQueueDepth += other.writeQueueDepth;
+		writeQueueBytes += other.writeQueueBytes;
+		writeQueueHighWatermark = qMax(writeQueueHighWatermark, other.writeQueueHighWatermark);
+		updateWakeups += other.updateWakeups;
+		notifierWakeups += other.notifierWakeups;
+		return *this;
+	}
+
+	// for computing the change since an earlier snapshot. the high
+	//   watermark is left as is
+	SocketStats & operator-=(const SocketStats &other)
+	{
+		messagesRead -= other.messagesRead;
+		framesRead -= other.framesRead;
+		bytesRead -= other.bytesRead;
+		messagesWritten -= other.messagesWritten;
+		framesWritten -= other.framesWritten;
+		bytesWritten -= other.bytesWritten;
+		messagesDropped -= other.messagesDropped;
+		writesRefused -= other.writesRefused;
+		writeQueueDepth -= other.writeQueueDepth;
+		writeQueueBytes -= other.writeQueueBytes;
+		updateWakeups -= other.updateWakeups;
+		notifierWakeups -= other.notifierWakeups;
+		return *this;
+	}
+};
+
+}
+
+#endif
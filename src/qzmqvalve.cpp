@@ -24,6 +24,8 @@
 #include "qzmqvalve.h"
 
 #include <QPointer>
+#include <QTimer>
+#include <QElapsedTimer>
 #include "qzmqsocket.h"
 
 namespace QZmq {
@@ -38,6 +40,19 @@ public:
 	bool isOpen;
 	bool pendingRead;
 	int maxReadsPerEvent;
+	int timeBudget;
+	qint64 avgReadCost;
+	bool batchDelivery;
+	double msgRate;
+	double msgBurst;
+	double msgTokens;
+	double byteRate;
+	double byteBurst;
+	double byteTokens;
+	QElapsedTimer rateClock;
+	qint64 lastRefill;
+	QTimer *rateTimer;
+	QPointer<QObject> scheduler;
 
 	Private(Valve *_q) :
 		QObject(_q),
@@ -45,8 +60,30 @@ public:
 		sock(0),
 		isOpen(false),
 		pendingRead(false),
-		maxReadsPerEvent(100)
+		maxReadsPerEvent(100),
+		timeBudget(-1),
+		avgReadCost(0),
+		batchDelivery(false),
+		msgRate(0),
+		msgBurst(0),
+		msgTokens(0),
+		byteRate(0),
+		byteBurst(0),
+		byteTokens(0),
+		lastRefill(0)
 	{
+		rateTimer = new QTimer(this);
+		connect(rateTimer, SIGNAL(timeout()), SLOT(rateTimer_timeout()));
+		rateTimer->setSingleShot(true);
+
+		rateClock.start();
+	}
+
+	~Private()
+	{
+		rateTimer->disconnect(this);
+		rateTimer->setParent(0);
+		rateTimer->deleteLater();
 	}
 
 	void setup(QZmq::Socket *_sock)
@@ -64,8 +101,270 @@ public:
 		QMetaObject::invokeMethod(this, "queuedRead", Qt::QueuedConnection);
 	}
 
+	void refillTokens()
+	{
+		qint64 now = rateClock.nsecsElapsed();
+		double secs = (double)(now - lastRefill) / 1000000000.0;
+		lastRefill = now;
+
+		if(msgRate > 0)
+			msgTokens = qMin(msgBurst, msgTokens + msgRate * secs);
+		if(byteRate > 0)
+			byteTokens = qMin(byteBurst, byteTokens + byteRate * secs);
+	}
+
+	// return true if the rate limits allow reading another message. the
+	//   byte limit allows a read as long as the bucket isn't empty, since
+	//   we can't know the size beforehand. an oversized message puts the
+	//   bucket into debt, which must be paid off before the next read
+	bool rateAllowsRead()
+	{
+		if(msgRate <= 0 && byteRate <= 0)
+			return true;
+
+		refillTokens();
+
+		if(msgRate > 0 && msgTokens < 1)
+			return false;
+		if(byteRate > 0 && byteTokens <= 0)
+			return false;
+
+		return true;
+	}
+
+	void consumeTokens(const QList<QByteArray> &message)
+	{
+		if(msgRate > 0)
+			msgTokens -= 1;
+
+		if(byteRate > 0)
+		{
+			foreach(const QByteArray &buf, message)
+				byteTokens -= buf.size();
+		}
+	}
+
+	// schedule a read for when the buckets will allow it
+	void waitForTokens()
+	{
+		if(rateTimer->isActive())
+			return;
+
+		double secs = 0;
+		if(msgRate > 0 && msgTokens < 1)
+			secs = qMax(secs, (1 - msgTokens) / msgRate);
+		if(byteRate > 0 && byteTokens <= 0)
+			secs = qMax(secs, (1 - byteTokens) / byteRate);
+
+		rateTimer->start(qMax((int)(secs * 1000 + 0.999), 1));
+	}
+
+	// how many messages to handle between looks at the clock. the more
+	//   messages fit in the budget, the less often we need to look
+	int clockCheckInterval() const
+	{
+		if(avgReadCost <= 0)
+			return 1;
+
+		qint64 perBudget = ((qint64)timeBudget * 1000) / avgReadCost;
+		return (int)qBound((qint64)1, perBudget / 8, (qint64)1000);
+	}
+
+	void recordReadCost(qint64 nsecs, int count)
+	{
+		if(count <= 0)
+			return;
+
+		qint64 cost = qMax(nsecs / count, (qint64)1);
+		if(avgReadCost <= 0)
+			avgReadCost = cost;
+		else
+			avgReadCost = (avgReadCost * 7 + cost) / 8;
+	}
+
+	void tryReadTimed()
+	{
+		QPointer<QObject> self = this;
+
+		qint64 budget = (qint64)timeBudget * 1000;
+		int interval = clockCheckInterval();
+
+		QElapsedTimer timer;
+		timer.start();
+
+		int count = 0;
+		int sinceCheck = 0;
+		while(isOpen && sock->canRead())
+		{
+			if(!rateAllowsRead())
+			{
+				recordReadCost(timer.nsecsElapsed(), count);
+				waitForTokens();
+				return;
+			}
+
+			if(sinceCheck >= interval)
+			{
+				sinceCheck = 0;
+
+				qint64 elapsed = timer.nsecsElapsed();
+				if(elapsed >= budget)
+				{
+					recordReadCost(elapsed, count);
+					queueRead();
+					return;
+				}
+			}
+
+			QList<QByteArray> msg = sock->read();
+
+			if(!msg.isEmpty())
+			{
+				consumeTokens(msg);
+
+				emit q->readyRead(msg);
+				if(!self)
+					return;
+			}
+
+			++count;
+			++sinceCheck;
+		}
+
+		recordReadCost(timer.nsecsElapsed(), count);
+	}
+
+	// reads up to max messages and delivers them as one batch. returns the
+	//   number of messages read
+	int readBatch(int max)
+	{
+		QPointer<QObject> self = this;
+
+		int maxBytes = -1;
+		if(msgRate > 0 || byteRate > 0)
+		{
+			if(!rateAllowsRead())
+			{
+				waitForTokens();
+				return 0;
+			}
+
+			if(msgRate > 0)
+				max = qMin(max, (int)msgTokens);
+			if(byteRate > 0)
+				maxBytes = (int)qBound(1.0, byteTokens, (double)0x7fffffff);
+		}
+
+		QElapsedTimer timer;
+		timer.start();
+
+		QList< QList<QByteArray> > messages = sock->readBatch(max, maxBytes);
+
+		foreach(const QList<QByteArray> &msg, messages)
+			consumeTokens(msg);
+
+		if(!messages.isEmpty())
+		{
+			emit q->readyReadBatch(messages);
+			if(!self)
+				return messages.count();
+		}
+
+		recordReadCost(timer.nsecsElapsed(), messages.count());
+
+		return messages.count();
+	}
+
+	void tryReadBatch()
+	{
+		if(!isOpen || !sock->canRead())
+			return;
+
+		QPointer<QObject> self = this;
+
+		// with a time budget, size the batch by how many messages we
+		//   expect to be able to handle within it
+		int max = maxReadsPerEvent;
+		if(timeBudget > 0 && avgReadCost > 0)
+			max = (int)qBound((qint64)1, ((qint64)timeBudget * 1000) / avgReadCost, (qint64)100000);
+
+		readBatch(max);
+		if(!self)
+			return;
+
+		if(isOpen && sock->canRead())
+		{
+			if(rateAllowsRead())
+				queueRead();
+			else
+				waitForTokens();
+		}
+	}
+
+	bool canReadNow()
+	{
+		if(!isOpen || !sock->canRead())
+			return false;
+
+		if(!rateAllowsRead())
+		{
+			// the scheduler will hear from us once the wait is over
+			waitForTokens();
+			return false;
+		}
+
+		return true;
+	}
+
+	// reads up to max messages right away, on behalf of a scheduler.
+	//   returns the number of messages read
+	int readNow(int max)
+	{
+		if(batchDelivery)
+			return readBatch(max);
+
+		QPointer<QObject> self = this;
+
+		int count = 0;
+		while(count < max && canReadNow())
+		{
+			QList<QByteArray> msg = sock->read();
+			++count;
+
+			if(!msg.isEmpty())
+			{
+				consumeTokens(msg);
+
+				emit q->readyRead(msg);
+				if(!self)
+					break;
+			}
+		}
+
+		return count;
+	}
+
 	void tryRead()
 	{
+		if(scheduler)
+		{
+			// let the scheduler decide when we read
+			QMetaObject::invokeMethod(scheduler, "valveReady", Qt::DirectConnection, Q_ARG(QZmq::Valve*, q));
+			return;
+		}
+
+		if(batchDelivery)
+		{
+			tryReadBatch();
+			return;
+		}
+
+		if(timeBudget > 0)
+		{
+			tryReadTimed();
+			return;
+		}
+
 		QPointer<QObject> self = this;
 
 		int count = 0;
@@ -77,10 +376,18 @@ public:
 				return;
 			}
 
+			if(!rateAllowsRead())
+			{
+				waitForTokens();
+				return;
+			}
+
 			QList<QByteArray> msg = sock->read();
 
 			if(!msg.isEmpty())
 			{
+				consumeTokens(msg);
+
 				emit q->readyRead(msg);
 				if(!self)
 					return;
@@ -104,6 +411,14 @@ private slots:
 		pendingRead = false;
 		tryRead();
 	}
+
+	void rateTimer_timeout()
+	{
+		if(pendingRead)
+			return;
+
+		tryRead();
+	}
 };
 
 Valve::Valve(QZmq::Socket *sock, QObject *parent) :
@@ -128,6 +443,53 @@ void Valve::setMaxReadsPerEvent(int max)
 	d->maxReadsPerEvent = max;
 }
 
+void Valve::setTimeBudget(int usecs)
+{
+	d->timeBudget = usecs;
+}
+
+void Valve::setBatchDeliveryEnabled(bool enable)
+{
+	d->batchDelivery = enable;
+}
+
+void Valve::setRateLimit(double messagesPerSecond, int burst)
+{
+	d->refillTokens();
+
+	d->msgRate = messagesPerSecond;
+	d->msgBurst = (burst > 0 ? burst : qMax(messagesPerSecond, 1.0));
+	d->msgTokens = d->msgBurst;
+}
+
+void Valve::setByteRateLimit(double bytesPerSecond, qint64 burst)
+{
+	d->refillTokens();
+
+	d->byteRate = bytesPerSecond;
+	d->byteBurst = (burst > 0 ? (double)burst : qMax(bytesPerSecond, 1.0));
+	d->byteTokens = d->byteBurst;
+}
+
+void Valve::setScheduler(QObject *scheduler)
+{
+	d->scheduler = scheduler;
+
+	// back on our own, pick up anything left unread
+	if(!scheduler && d->isOpen && d->sock->canRead())
+		d->queueRead();
+}
+
+bool Valve::canReadNow()
+{
+	return d->canReadNow();
+}
+
+int Valve::readNow(int max)
+{
+	return d->readNow(max);
+}
+
 void Valve::open()
 {
 	if(!d->isOpen)
@@ -42,16 +42,47 @@ public:
 
 	void setMaxReadsPerEvent(int max);
 
+	// if set, reading continues until this much time has been spent in an
+	//   event, rather than stopping after a fixed number of messages. the
+	//   clock is consulted less often when messages are cheap to handle.
+	//   -1 means disabled (default = -1)
+	void setTimeBudget(int usecs);
+
+	// if enabled, all messages read in one pass are delivered together via
+	//   readyReadBatch, instead of one at a time via readyRead. the batch
+	//   size is limited by maxReadsPerEvent, or, if a time budget is set,
+	//   by how many messages are expected to be handled within it.
+	//   default disabled
+	void setBatchDeliveryEnabled(bool enable);
+
+	// limits how fast messages are read, using token buckets. the burst
+	//   is the bucket size, and defaults to one second's worth. when the
+	//   limit is reached, reading resumes on its own once allowed. a rate
+	//   of 0 means no limit (default = 0)
+	void setRateLimit(double messagesPerSecond, int burst = -1);
+	void setByteRateLimit(double bytesPerSecond, qint64 burst = -1);
+
 	void open();
 	void close();
 
 signals:
 	void readyRead(const QList<QByteArray> &message);
+	void readyReadBatch(const QList< QList<QByteArray> > &messages);
 
 private:
 	class Private;
 	friend class Private;
 	Private *d;
+
+	friend class ValveGroup;
+
+	// for ValveGroup. once a scheduler is set, the valve no longer reads
+	//   on its own. instead it invokes the scheduler's
+	//   valveReady(QZmq::Valve*) slot when it may have something to read,
+	//   and the scheduler calls readNow
+	void setScheduler(QObject *scheduler);
+	bool canReadNow();
+	int readNow(int max);
 };
 
 }
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qzmqvalvegroup.h"
+
+#include <assert.h>
+#include <QHash>
+#include <QPointer>
+#include "qzmqvalve.h"
+
+namespace QZmq {
+
+class ValveGroup::Private : public QObject
+{
+	Q_OBJECT
+
+public:
+	class Entry
+	{
+	public:
+		Valve *valve;
+		int weight;
+		int deficit;
+		bool active;
+	};
+
+	ValveGroup *q;
+	int maxReadsPerEvent;
+	QHash<Valve*, Entry*> entries;
+	QList<Entry*> active;
+	bool pendingTurn;
+
+	Private(ValveGroup *_q) :
+		QObject(_q),
+		q(_q),
+		maxReadsPerEvent(100),
+		pendingTurn(false)
+	{
+	}
+
+	~Private()
+	{
+		foreach(Entry *e, entries)
+		{
+			disconnect(e->valve, SIGNAL(destroyed(QObject*)), this, SLOT(valve_destroyed(QObject*)));
+			e->valve->setScheduler(0);
+			delete e;
+		}
+	}
+
+	void add(Valve *valve, int weight)
+	{
+		assert(!entries.contains(valve));
+		assert(weight > 0);
+
+		Entry *e = new Entry;
+		e->valve = valve;
+		e->weight = weight;
+		e->deficit = 0;
+		e->active = false;
+		entries.insert(valve, e);
+
+		connect(valve, SIGNAL(destroyed(QObject*)), SLOT(valve_destroyed(QObject*)));
+		valve->setScheduler(this);
+
+		// it may already have something waiting
+		activate(e);
+	}
+
+	void remove(Valve *valve)
+	{
+		Entry *e = entries.value(valve);
+		if(!e)
+			return;
+
+		entries.remove(valve);
+		active.removeAll(e);
+		delete e;
+	}
+
+	void activate(Entry *e)
+	{
+		if(!e->active)
+		{
+			e->active = true;
+			e->deficit = 0;
+			active += e;
+		}
+
+		queueTurn();
+	}
+
+	void deactivate(Entry *e)
+	{
+		e->active = false;
+		e->deficit = 0;
+		active.removeAll(e);
+	}
+
+	void queueTurn()
+	{
+		if(pendingTurn)
+			return;
+
+		pendingTurn = true;
+		QMetaObject::invokeMethod(this, "doTurn", Qt::QueuedConnection);
+	}
+
+public slots:
+	void valveReady(QZmq::Valve *valve)
+	{
+		Entry *e = entries.value(valve);
+		if(e)
+			activate(e);
+	}
+
+	void doTurn()
+	{
+		pendingTurn = false;
+
+		QPointer<QObject> self = this;
+
+		int budget = maxReadsPerEvent;
+		while(budget > 0 && !active.isEmpty())
+		{
+			Entry *e = active.first();
+			Valve *valve = e->valve;
+
+			// a fresh quantum each time a valve comes to the front. a valve
+			//   that was cut off by the budget keeps what it had left
+			if(e->deficit <= 0)
+				e->deficit += e->weight;
+
+			if(!valve->canReadNow())
+			{
+				// closed, drained, or rate limited. the valve lets us know
+				//   when it has something again
+				deactivate(e);
+				continue;
+			}
+
+			int count = valve->readNow(qMin(e->deficit, budget));
+			if(!self)
+				return;
+
+			// removed during a handler?
+			if(entries.value(valve) != e)
+				continue;
+
+			if(count == 0)
+			{
+				deactivate(e);
+				continue;
+			}
+
+			budget -= count;
+			e->deficit -= count;
+
+			if(e->deficit <= 0 && e->active && active.first() == e)
+			{
+				active.removeFirst();
+				active += e;
+			}
+		}
+
+		if(!active.isEmpty())
+			queueTurn();
+	}
+
+	void valve_destroyed(QObject *obj)
+	{
+		remove(static_cast<Valve*>(obj));
+	}
+};
+
+ValveGroup::ValveGroup(QObject *parent) :
+	QObject(parent)
+{
+	d = new Private(this);
+}
+
+ValveGroup::~ValveGroup()
+{
+	delete d;
+}
+
+void ValveGroup::setMaxReadsPerEvent(int max)
+{
+	d->maxReadsPerEvent = max;
+}
+
+void ValveGroup::addValve(Valve *valve, int weight)
+{
+	d->add(valve, weight);
+}
+
+void ValveGroup::removeValve(Valve *valve)
+{
+	if(!d->entries.contains(valve))
+		return;
+
+	disconnect(valve, SIGNAL(destroyed(QObject*)), d, SLOT(valve_destroyed(QObject*)));
+	d->remove(valve);
+	valve->setScheduler(0);
+}
+
+void ValveGroup::setWeight(Valve *valve, int weight)
+{
+	assert(weight > 0);
+
+	Private::Entry *e = d->entries.value(valve);
+	if(e)
+		e->weight = weight;
+}
+
+}
+
+#include "qzmqvalvegroup.moc"
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026 Justin Karneges
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef QZMQVALVEGROUP_H
+#define QZMQVALVEGROUP_H
+
+#include <QObject>
+
+namespace QZmq {
+
+class Valve;
+
+// reads from many valves fairly, under one shared budget per event. each
+//   valve gets a share of reads in proportion to its weight (deficit round
+//   robin, counted in messages). valves added to a group stop reading on
+//   their own, but otherwise behave as usual (open/close, rate limits,
+//   batch delivery). the group does not take ownership of valves
+class ValveGroup : public QObject
+{
+	Q_OBJECT
+
+public:
+	ValveGroup(QObject *parent = 0);
+	~ValveGroup();
+
+	// total reads across all valves before returning to the event loop
+	//   (default = 100)
+	void setMaxReadsPerEvent(int max);
+
+	void addValve(Valve *valve, int weight = 1);
+	void removeValve(Valve *valve);
+	void setWeight(Valve *valve, int weight);
+
+private:
+	Q_DISABLE_COPY(ValveGroup)
+
+	class Private;
+	friend class Private;
+	Private *d;
+};
+
+}
+
+#endif
@@ -1,12 +1,31 @@
 HEADERS += \
 	$$PWD/qzmqcontext.h \
+	$$PWD/qzmqframe.h \
 	$$PWD/qzmqsocket.h \
+	$$PWD/qzmqsocketstats.h \
+	$$PWD/qzmqlatencyhistogram.h \
+	$$PWD/qzmqsocketgroup.h \
 	$$PWD/qzmqvalve.h \
+	$$PWD/qzmqvalvegroup.h \
+	$$PWD/qzmqproxy.h \
+	$$PWD/qzmqmonitor.h \
+	$$PWD/qzmqcapture.h \
+	$$PWD/qzmqreplay.h \
 	$$PWD/qzmqreqmessage.h \
-	$$PWD/qzmqreprouter.h
+	$$PWD/qzmqreprouter.h \
+	$$PWD/qzmqreqclient.h
 
 SOURCES += \
 	$$PWD/qzmqcontext.cpp \
+	$$PWD/qzmqframe.cpp \
 	$$PWD/qzmqsocket.cpp \
+	$$PWD/qzmqlatencyhistogram.cpp \
+	$$PWD/qzmqsocketgroup.cpp \
 	$$PWD/qzmqvalve.cpp \
-	$$PWD/qzmqreprouter.cpp
+	$$PWD/qzmqvalvegroup.cpp \
+	$$PWD/qzmqproxy.cpp \
+	$$PWD/qzmqmonitor.cpp \
+	$$PWD/qzmqcapture.cpp \
+	$$PWD/qzmqreplay.cpp \
+	$$PWD/qzmqreprouter.cpp \
+	$$PWD/qzmqreqclient.cpp